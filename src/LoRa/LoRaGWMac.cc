@@ -16,6 +16,7 @@
 #include "LoRaGWMac.h"
 #include "inet/common/ModuleAccess.h"
 #include "../LoRaPhy/LoRaPhyPreamble_m.h"
+#include "../LoRaPhy/LoRaAirtime.h"
 #include "inet/common/ProtocolTag_m.h"
 
 
@@ -118,13 +119,9 @@ void LoRaGWMac::handleUpperMessage(cMessage *msg)
 
 
         waitingForDC = true;
-        double delta;
-        if(frame->getLoRaSF() == 7) delta = 0.61696;
-        if(frame->getLoRaSF() == 8) delta = 1.23392;
-        if(frame->getLoRaSF() == 9) delta = 2.14016;
-        if(frame->getLoRaSF() == 10) delta = 4.28032;
-        if(frame->getLoRaSF() == 11) delta = 7.24992;
-        if(frame->getLoRaSF() == 12) delta = 14.49984;
+        // the 10% duty cycle of the downlink keeps the gateway silent for 9
+        // times the time on air of the frame
+        double delta = 10 * LoRaAirtime::getTimeOnAir(pkt->getByteLength(), frame->getLoRaSF(), frame->getLoRaBW().get(), frame->getLoRaCR(), frame->getLoRaUseHeader());
         scheduleAt(simTime() + delta, dutyCycleTimer);
         GW_forwardedDown++;
         pkt->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
@@ -16,6 +16,7 @@
 #include "LoRaGWRadio.h"
 #include "LoRaPhy/LoRaMedium.h"
 #include "LoRaPhy/LoRaPhyPreamble_m.h"
+#include "LoRaPhy/LoRaSensitivityTable.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/SignalTag_m.h"
 
 
@@ -27,26 +28,70 @@ void LoRaGWRadio::initialize(int stage)
 {
     FlatRadioBase::initialize(stage);
     iAmGateway = par("iAmGateway").boolValue();
+    if (stage == INITSTAGE_LOCAL) {
+        numDemodulators = par("numDemodulators");
+        if (numDemodulators == 0 || numDemodulators < -1)
+            throw cRuntimeError("Invalid number of demodulators: %d, use -1 for unlimited", numDemodulators);
+        const char *preemption = par("demodulatorPreemption");
+        if (!strcmp(preemption, "none"))
+            demodulatorPreemption = PREEMPT_NONE;
+        else if (!strcmp(preemption, "weakest"))
+            demodulatorPreemption = PREEMPT_WEAKEST;
+        else
+            throw cRuntimeError("Unknown demodulator preemption: '%s'", preemption);
+        if (numDemodulators > 0) {
+            demodulators.resize(numDemodulators);
+            for (int i = numDemodulators - 1; i >= 0; i--)
+                freeDemodulators.push_back(&demodulators[i]);
+        }
+        numReceptionsWithoutDemodulator = 0;
+        numReceptionsPreempted = 0;
+        maxDownlinkDeferral = par("maxDownlinkDeferral");
+        downlinkTimer = new cMessage("downlinkTimer");
+        numDownlinksDeferred = 0;
+        loRaCF = units::values::Hz(par("loRaCF"));
+        loRaBW = units::values::Hz(par("loRaBW"));
+        loRaSF = par("loRaSF");
+    }
     if (stage == INITSTAGE_LAST) {
         setRadioMode(RADIO_MODE_TRANSCEIVER);
         LoRaGWRadioReceptionStarted = registerSignal("LoRaGWRadioReceptionStarted");
         LoRaGWRadioReceptionFinishedCorrect = registerSignal("LoRaGWRadioReceptionFinishedCorrect");
         LoRaGWRadioReceptionStarted_counter = 0;
         LoRaGWRadioReceptionFinishedCorrect_counter = 0;
-        iAmTransmiting = false;
     }
 }
 
+LoRaGWRadio::~LoRaGWRadio()
+{
+    cancelAndDelete(downlinkTimer);
+    for (auto packet : deferredDownlinks)
+        delete packet;
+}
+
 void LoRaGWRadio::finish()
 {
     FlatRadioBase::finish();
     recordScalar("DER - Data Extraction Rate", double(LoRaGWRadioReceptionFinishedCorrect_counter)/LoRaGWRadioReceptionStarted_counter);
+    recordScalar("numReceptionsWithoutDemodulator", numReceptionsWithoutDemodulator);
+    recordScalar("numReceptionsPreempted", numReceptionsPreempted);
+    recordScalar("numReceptionsLostToTx", halfDuplex.getNumReceptionsLostToTx());
+    recordScalar("numDownlinksDeferred", numDownlinksDeferred);
+    for (size_t i = 0; i < demodulators.size(); i++) {
+        const DemodulatorSlot& slot = demodulators[i];
+        simtime_t busyTime = slot.busyTime + (slot.timer != nullptr ? simTime() - slot.busySince : SIMTIME_ZERO);
+        std::string name = "demodulator[" + std::to_string(i) + "] ";
+        recordScalar((name + "occupancy").c_str(), simTime() > 0 ? busyTime.dbl() / simTime().dbl() : 0.0);
+        recordScalar((name + "numReceptions").c_str(), slot.numReceptions);
+    }
 }
 
 void LoRaGWRadio::handleSelfMessage(cMessage *message)
 {
     if (message == switchTimer)
         handleSwitchTimer(message);
+    else if (message == downlinkTimer)
+        handleDownlinkTimer();
     else if (isTransmissionTimer(message))
         handleTransmissionTimer(message);
     else if (isReceptionTimer(message))
@@ -101,7 +146,27 @@ void LoRaGWRadio::handleUpperPacket(Packet *packet)
     packet->insertAtFront(preamble);
     EV << "Wysylam " << preamble->getPower() << " " << preamble->getSpreadFactor() << endl;
 
+    simtime_t startTime = halfDuplex.getTransmissionStart(simTime(), maxDownlinkDeferral);
+    if (startTime > simTime() || !deferredDownlinks.empty()) {
+        EV_INFO << "Deferring downlink " << packet << " to " << startTime << " to spare ongoing receptions" << endl;
+        deferredDownlinks.push_back(packet);
+        numDownlinksDeferred++;
+        if (!downlinkTimer->isScheduled())
+            scheduleAt(startTime, downlinkTimer);
+    }
+    else if (separateTransmissionParts)
+        startTransmission(packet, IRadioSignal::SIGNAL_PART_PREAMBLE);
+    else
+        startTransmission(packet, IRadioSignal::SIGNAL_PART_WHOLE);
+}
 
+void LoRaGWRadio::handleDownlinkTimer()
+{
+    // endTransmission() picks up the queue when the current one is over
+    if (halfDuplex.isTransmitting())
+        return;
+    Packet *packet = deferredDownlinks.front();
+    deferredDownlinks.pop_front();
     if (separateTransmissionParts)
         startTransmission(packet, IRadioSignal::SIGNAL_PART_PREAMBLE);
     else
@@ -110,11 +175,18 @@ void LoRaGWRadio::handleUpperPacket(Packet *packet)
 
 void LoRaGWRadio::startTransmission(Packet *macFrame, IRadioSignal::SignalPart part)
 {
-    if(iAmTransmiting == false)
+    if(!halfDuplex.isTransmitting())
     {
-        iAmTransmiting = true;
         auto radioFrame = createSignal(macFrame);
         auto transmission = radioFrame->getTransmission();
+        int numLost = halfDuplex.startTransmission(transmission->getEndTime());
+        if (numLost > 0)
+            EV_INFO << "Transmission overlaps " << numLost << " ongoing receptions, they are lost" << endl;
+        // the demodulators of the lost receptions are free again
+        for (auto& slot : demodulators)
+            if (slot.timer != nullptr)
+                releaseDemodulator(slot.timer);
+        receptionTimer = nullptr;
 
         cMessage *txTimer = new cMessage("transmissionTimer");
         txTimer->setKind(part);
@@ -140,7 +212,9 @@ void LoRaGWRadio::continueTransmission(cMessage *timer)
 
 void LoRaGWRadio::endTransmission(cMessage *timer)
 {
-    iAmTransmiting = false;
+    halfDuplex.endTransmission();
+    if (!deferredDownlinks.empty() && !downlinkTimer->isScheduled())
+        scheduleAt(halfDuplex.getTransmissionStart(simTime(), maxDownlinkDeferral), downlinkTimer);
     auto part = (IRadioSignal::SignalPart)timer->getKind();
     auto signal = static_cast<WirelessSignal *>(timer->getContextPointer());
     auto transmission = signal->getTransmission();
@@ -166,6 +240,17 @@ bool LoRaGWRadio::isReceptionTimer(const cMessage *message) const
     return !strcmp(message->getName(), "receptionTimer");
 }
 
+bool LoRaGWRadio::isReceivable(const WirelessSignal *radioFrame) const
+{
+    // no side effects, unlike the reception attempt that evaluates and
+    // reports the collisions of the frame
+    auto transmission = radioFrame->getTransmission();
+    if (!receiver->computeIsReceptionPossible(radioFrame->getListening(), transmission))
+        return false;
+    auto loRaReception = check_and_cast<const LoRaReception *>(radioFrame->getReception());
+    return loRaReception->getPower() >= LoRaSensitivityTable::getSensitivity(loRaReception->getLoRaSF(), loRaReception->getLoRaBW());
+}
+
 void LoRaGWRadio::startReception(cMessage *timer, IRadioSignal::SignalPart part)
 {
     auto radioFrame = static_cast<WirelessSignal *>(timer->getControlInfo());
@@ -174,26 +259,29 @@ void LoRaGWRadio::startReception(cMessage *timer, IRadioSignal::SignalPart part)
     emit(LoRaGWRadioReceptionStarted, true);
     if (simTime() >= getSimulation()->getWarmupPeriod())
         LoRaGWRadioReceptionStarted_counter++;
-    if (isReceiverMode(radioMode) && arrival->getStartTime(part) == simTime() && iAmTransmiting == false) {
+    if (isReceiverMode(radioMode) && arrival->getStartTime(part) == simTime() && !halfDuplex.isTransmitting()) {
         auto transmission = radioFrame->getTransmission();
-        auto isReceptionAttempted = medium->isReceptionAttempted(this, transmission, part);
+        // channels outside the plan of the receiver are rejected before the
+        // medium computes the reception power and the interference
+        auto isReceptionAttempted = receiver->computeIsReceptionPossible(radioFrame->getListening(), transmission) && medium->isReceptionAttempted(this, transmission, part);
         EV_INFO << "LoRaGWRadio Reception started: " << (isReceptionAttempted ? "attempting" : "not attempting") << " " << (WirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(part) << " as " << reception << endl;
-        if (isReceptionAttempted) {
-            if(iAmGateway) {
-                concurrentReceptions.push_back(timer);
-            }
+        if (isReceptionAttempted && (!iAmGateway || allocateDemodulator(timer) != nullptr)) {
             receptionTimer = timer;
+            halfDuplex.startReception(timer, arrival->getEndTime());
         }
     }
-    else
+    else {
+        if (halfDuplex.isTransmitting() && isReceivable(radioFrame))
+            halfDuplex.blockReception();
         EV_INFO << "LoRaGWRadio Reception started: ignoring " << (WirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(part) << " as " << reception << endl;
+    }
     timer->setKind(part);
     scheduleAt(arrival->getEndTime(part), timer);
     //updateTransceiverState();
     //updateTransceiverPart();
     radioMode = RADIO_MODE_TRANSCEIVER;
     check_and_cast<LoRaMedium *>(medium.get())->emit(IRadioMedium::signalArrivalStartedSignal, check_and_cast<const cObject *>(reception));
-    if(iAmGateway) EV << "[MSDebug] start reception, size : " << concurrentReceptions.size() << endl;
+    if(iAmGateway) EV << "[MSDebug] start reception, size : " << demodulators.size() - freeDemodulators.size() << endl;
 }
 
 void LoRaGWRadio::continueReception(cMessage *timer)
@@ -203,30 +291,32 @@ void LoRaGWRadio::continueReception(cMessage *timer)
     auto radioFrame = static_cast<WirelessSignal *>(timer->getControlInfo());
     auto arrival = radioFrame->getArrival();
     auto reception = radioFrame->getReception();
-    if(iAmGateway) {
-        std::list<cMessage *>::iterator it;
-        for (it=concurrentReceptions.begin(); it!=concurrentReceptions.end(); it++) {
-            if(*it == timer) receptionTimer = timer;
-        }
-    }
-    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime(previousPart) == simTime() && iAmTransmiting == false) {
+    if(iAmGateway && getDemodulator(timer) != nullptr)
+        receptionTimer = timer;
+    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime(previousPart) == simTime() && !halfDuplex.isTransmitting() && !halfDuplex.isReceptionLost(timer)) {
         auto transmission = radioFrame->getTransmission();
         bool isReceptionSuccessful = medium->isReceptionSuccessful(this, transmission, previousPart);
         EV_INFO << "LoRaGWRadio Reception ended: " << (isReceptionSuccessful ? "successfully" : "unsuccessfully") << " for " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(previousPart) << " as " << reception << endl;
         if (!isReceptionSuccessful) {
             receptionTimer = nullptr;
-            if(iAmGateway) concurrentReceptions.remove(timer);
+            if(iAmGateway) releaseDemodulator(timer);
+            halfDuplex.endReception(timer);
         }
         auto isReceptionAttempted = medium->isReceptionAttempted(this, transmission, nextPart);
         EV_INFO << "LoRaGWRadio Reception started: " << (isReceptionAttempted ? "attempting" : "not attempting") << " " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(nextPart) << " as " << reception << endl;
         if (!isReceptionAttempted) {
             receptionTimer = nullptr;
-            if(iAmGateway) concurrentReceptions.remove(timer);
+            if(iAmGateway) releaseDemodulator(timer);
+            halfDuplex.endReception(timer);
         }
     }
     else {
         EV_INFO << "LoRaGWRadio Reception ended: ignoring " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(previousPart) << " as " << reception << endl;
         EV_INFO << "LoRaGWRadio Reception started: ignoring " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(nextPart) << " as " << reception << endl;
+        // the reception can't complete any more, its demodulator is free
+        if (timer == receptionTimer)
+            receptionTimer = nullptr;
+        releaseDemodulator(timer);
     }
     timer->setKind(nextPart);
     scheduleAt(arrival->getEndTime(nextPart), timer);
@@ -241,13 +331,9 @@ void LoRaGWRadio::endReception(cMessage *timer)
     auto radioFrame = static_cast<WirelessSignal *>(timer->getControlInfo());
     auto arrival = radioFrame->getArrival();
     auto reception = radioFrame->getReception();
-    std::list<cMessage *>::iterator it;
-    if(iAmGateway) {
-        for (it=concurrentReceptions.begin(); it!=concurrentReceptions.end(); it++) {
-            if(*it == timer) receptionTimer = timer;
-        }
-    }
-    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime() == simTime() && iAmTransmiting == false) {
+    if(iAmGateway && getDemodulator(timer) != nullptr)
+        receptionTimer = timer;
+    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime() == simTime() && !halfDuplex.isTransmitting() && !halfDuplex.isReceptionLost(timer)) {
         auto transmission = radioFrame->getTransmission();
 // TODO: this would draw twice from the random number generator in isReceptionSuccessful: auto isReceptionSuccessful = medium->isReceptionSuccessful(this, transmission, part);
         auto isReceptionSuccessful = medium->getReceptionDecision(this, radioFrame->getListening(), transmission, part)->isReceptionSuccessful();
@@ -263,13 +349,15 @@ void LoRaGWRadio::endReception(cMessage *timer)
             sendUp(macFrame);
         }
         receptionTimer = nullptr;
-        if(iAmGateway) concurrentReceptions.remove(timer);
     }
     else
         EV_INFO << "LoRaGWRadio Reception ended: ignoring " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(part) << " as " << reception << endl;
     //updateTransceiverState();
     //updateTransceiverPart();
     radioMode = RADIO_MODE_TRANSCEIVER;
+    // ignored receptions hold their demodulator too, the timer is deleted below
+    releaseDemodulator(timer);
+    halfDuplex.endReception(timer);
     check_and_cast<LoRaMedium *>(medium.get())->emit(IRadioMedium::signalArrivalEndedSignal, check_and_cast<const cObject *>(reception));
     delete timer;
 }
@@ -280,12 +368,67 @@ void LoRaGWRadio::abortReception(cMessage *timer)
     auto part = (IRadioSignal::SignalPart)timer->getKind();
     auto reception = radioFrame->getReception();
     EV_INFO << "LoRaGWRadio Reception aborted: for " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(part) << " as " << reception << endl;
-    if (timer == receptionTimer) {
-        if(iAmGateway) concurrentReceptions.remove(timer);
+    if (timer == receptionTimer)
         receptionTimer = nullptr;
-    }
+    releaseDemodulator(timer);
+    halfDuplex.endReception(timer);
     updateTransceiverState();
     updateTransceiverPart();
 }
 
+LoRaGWRadio::DemodulatorSlot *LoRaGWRadio::allocateDemodulator(cMessage *timer)
+{
+    DemodulatorSlot *slot = nullptr;
+    if (!freeDemodulators.empty()) {
+        slot = freeDemodulators.back();
+        freeDemodulators.pop_back();
+    }
+    else if (numDemodulators < 0) {
+        demodulators.emplace_back();
+        slot = &demodulators.back();
+    }
+    else if (demodulatorPreemption == PREEMPT_WEAKEST) {
+        auto power = [] (const cMessage *timer) {
+            auto radioFrame = static_cast<WirelessSignal *>(timer->getControlInfo());
+            return check_and_cast<const LoRaReception *>(radioFrame->getReception())->getPower();
+        };
+        DemodulatorSlot *weakest = nullptr;
+        for (auto& candidate : demodulators)
+            if (candidate.timer != nullptr && (weakest == nullptr || power(candidate.timer) < power(weakest->timer)))
+                weakest = &candidate;
+        if (weakest != nullptr && power(weakest->timer) < power(timer)) {
+            EV_INFO << "Demodulator taken over from the weaker reception of " << (WirelessSignal *)weakest->timer->getControlInfo() << endl;
+            cMessage *preemptedTimer = weakest->timer;
+            if (receptionTimer == preemptedTimer)
+                receptionTimer = nullptr;
+            releaseDemodulator(preemptedTimer);
+            halfDuplex.endReception(preemptedTimer);
+            numReceptionsPreempted++;
+            slot = freeDemodulators.back();
+            freeDemodulators.pop_back();
+        }
+    }
+    if (slot == nullptr) {
+        EV_INFO << "No free demodulator for " << (WirelessSignal *)timer->getControlInfo() << endl;
+        numReceptionsWithoutDemodulator++;
+        return nullptr;
+    }
+    slot->timer = timer;
+    slot->busySince = simTime();
+    slot->numReceptions++;
+    timer->setContextPointer(slot);
+    return slot;
+}
+
+void LoRaGWRadio::releaseDemodulator(cMessage *timer)
+{
+    DemodulatorSlot *slot = getDemodulator(timer);
+    if (slot == nullptr)
+        return;
+    slot->busyTime += simTime() - slot->busySince;
+    slot->timer = nullptr;
+    timer->setContextPointer(nullptr);
+    freeDemodulators.push_back(slot);
+}
+
 }
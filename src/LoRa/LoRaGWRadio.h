@@ -17,6 +17,7 @@
 #define LORA_LORAGWRADIO_H_
 
 #include "inet/physicallayer/wireless/common/base/packetlevel/FlatRadioBase.h"
+#include <deque>
 #include "LoRaPhy/LoRaTransmitter.h"
 #include "LoRaPhy/LoRaReceiver.h"
 #include "LoRaPhy/LoRaTransmission.h"
@@ -24,6 +25,7 @@
 #include "LoRaMacFrame_m.h"
 #include "inet/physicallayer/wireless/common//medium/RadioMedium.h"
 #include "LoRaPhy/LoRaMedium.h"
+#include "LoRaHalfDuplexArbiter.h"
 #include "inet/common/LayeredProtocolBase.h"
 
 namespace lpwan {
@@ -38,7 +40,13 @@ protected:
     virtual void handleUpperPacket(Packet *packet) override;
     void handleSignal(WirelessSignal *radioFrame) override;
 
-    bool iAmTransmiting;
+    LoRaHalfDuplexArbiter halfDuplex;
+    // downlinks held back by the arbiter until a gap in the uplinks
+    std::deque<Packet *> deferredDownlinks;
+    cMessage *downlinkTimer = nullptr;
+    simtime_t maxDownlinkDeferral;
+    long numDownlinksDeferred;
+    virtual void handleDownlinkTimer();
     virtual bool isTransmissionTimer(const cMessage *message) const;
     virtual void handleTransmissionTimer(cMessage *message) override;
     virtual void startTransmission(Packet *macFrame, IRadioSignal::SignalPart part) override;
@@ -47,15 +55,49 @@ protected:
 
     virtual bool isReceptionTimer(const cMessage *message) const override;
     virtual void startReception(cMessage *timer, IRadioSignal::SignalPart part) override;
+    // whether a frame arriving during a transmission would have been received
+    virtual bool isReceivable(const WirelessSignal *radioFrame) const;
     virtual void continueReception(cMessage *timer) override;
     virtual void endReception(cMessage *timer) override;
     virtual void abortReception(cMessage *timer) override;
 
+    /**
+     * Demodulator path of the concentrator. The slot of an ongoing reception
+     * is stored as the context pointer of its reception timer.
+     */
+    struct DemodulatorSlot
+    {
+        cMessage *timer = nullptr;
+        simtime_t busySince;
+        simtime_t busyTime;
+        long numReceptions = 0;
+    };
+    enum DemodulatorPreemption
+    {
+        PREEMPT_NONE,
+        PREEMPT_WEAKEST
+    };
+    int numDemodulators;
+    DemodulatorPreemption demodulatorPreemption;
+    // a deque keeps the slots in place when an unlimited pool grows
+    std::deque<DemodulatorSlot> demodulators;
+    std::vector<DemodulatorSlot *> freeDemodulators;
+    long numReceptionsWithoutDemodulator;
+    long numReceptionsPreempted;
+
+    virtual DemodulatorSlot *allocateDemodulator(cMessage *timer);
+    virtual void releaseDemodulator(cMessage *timer);
+    static DemodulatorSlot *getDemodulator(const cMessage *timer) { return static_cast<DemodulatorSlot *>(timer->getContextPointer()); }
 
 public:
+    virtual ~LoRaGWRadio();
+
     bool iAmGateway;
+    // band of the listenings of the gateway receiver
+    units::values::Hz loRaCF;
+    units::values::Hz loRaBW;
+    int loRaSF;
 
-    std::list<cMessage *>concurrentReceptions;
     std::list<cMessage *>concurrentTransmissions;
 
     long LoRaGWRadioReceptionStarted_counter;
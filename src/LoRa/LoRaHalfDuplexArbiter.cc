@@ -0,0 +1,60 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "LoRaHalfDuplexArbiter.h"
+
+namespace lpwan {
+
+int LoRaHalfDuplexArbiter::startTransmission(simtime_t endTime)
+{
+    int numLost = 0;
+    for (auto& elem : receptions) {
+        if (!elem.second.lostToTx) {
+            elem.second.lostToTx = true;
+            numLost++;
+        }
+    }
+    numReceptionsLostToTx += numLost;
+    transmitting = true;
+    transmissionEndTime = endTime;
+    return numLost;
+}
+
+void LoRaHalfDuplexArbiter::startReception(const cMessage *timer, simtime_t endTime)
+{
+    OngoingReception reception;
+    reception.endTime = endTime;
+    receptions[timer] = reception;
+}
+
+bool LoRaHalfDuplexArbiter::isReceptionLost(const cMessage *timer) const
+{
+    auto it = receptions.find(timer);
+    return it != receptions.end() && it->second.lostToTx;
+}
+
+simtime_t LoRaHalfDuplexArbiter::getTransmissionStart(simtime_t now, simtime_t maxDeferral) const
+{
+    simtime_t deadline = now + maxDeferral;
+    simtime_t start = now;
+    if (transmitting && transmissionEndTime > start && transmissionEndTime <= deadline)
+        start = transmissionEndTime;
+    for (const auto& elem : receptions)
+        if (!elem.second.lostToTx && elem.second.endTime > start && elem.second.endTime <= deadline)
+            start = elem.second.endTime;
+    return start;
+}
+
+} // namespace lpwan
@@ -0,0 +1,75 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef LORA_LORAHALFDUPLEXARBITER_H_
+#define LORA_LORAHALFDUPLEXARBITER_H_
+
+#include <omnetpp.h>
+#include <unordered_map>
+
+using namespace omnetpp;
+
+namespace lpwan {
+
+/**
+ * Arbitrates between the transmitter and the receptions of a half-duplex
+ * radio. It keeps the end time of every attempted reception, marks the ones
+ * overlapped by a transmission as lost to TX and predicts the earliest gap
+ * in the ongoing receptions where a transmission could be moved to.
+ */
+class LoRaHalfDuplexArbiter
+{
+  protected:
+    struct OngoingReception
+    {
+        simtime_t endTime;
+        bool lostToTx = false;
+    };
+
+    bool transmitting = false;
+    simtime_t transmissionEndTime;
+    std::unordered_map<const cMessage *, OngoingReception> receptions;
+    long numReceptionsLostToTx = 0;
+
+  public:
+    bool isTransmitting() const { return transmitting; }
+    /**
+     * Marks every ongoing reception lost and returns how many were lost.
+     */
+    int startTransmission(simtime_t endTime);
+    void endTransmission() { transmitting = false; }
+
+    void startReception(const cMessage *timer, simtime_t endTime);
+    void endReception(const cMessage *timer) { receptions.erase(timer); }
+    /**
+     * Accounts for a reception that would have been attempted if the radio
+     * was not transmitting.
+     */
+    void blockReception() { numReceptionsLostToTx++; }
+    bool isReceptionLost(const cMessage *timer) const;
+
+    /**
+     * Returns the start time of a transmission requested at now that may be
+     * deferred by at most maxDeferral: the latest end of the current
+     * transmission or of an ongoing reception within that limit, or now.
+     */
+    simtime_t getTransmissionStart(simtime_t now, simtime_t maxDeferral) const;
+
+    long getNumReceptionsLostToTx() const { return numReceptionsLostToTx; }
+};
+
+} // namespace lpwan
+
+#endif /* LORA_LORAHALFDUPLEXARBITER_H_ */
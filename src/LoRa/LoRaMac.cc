@@ -39,6 +39,7 @@ LoRaMac::~LoRaMac()
     cancelAndDelete(endListening_1);
     cancelAndDelete(endDelay_2);
     cancelAndDelete(endListening_2);
+    cancelAndDelete(rxWindowTimer);
     cancelAndDelete(mediumStateChange);
 }
 
@@ -62,6 +63,15 @@ void LoRaMac::initialize(int stage)
         waitDelay2Time = 1;
         listening2Time = 1;
 
+        const char *rxWindowScheduling = par("rxWindowScheduling");
+        if (!strcmp(rxWindowScheduling, "full"))
+            compressedRxWindows = false;
+        else if (!strcmp(rxWindowScheduling, "compressed"))
+            compressedRxWindows = true;
+        else
+            throw cRuntimeError("Unknown RX window scheduling: '%s'", rxWindowScheduling);
+        downlinksPossible = par("downlinksPossible");
+
         const char *addressString = par("address");
         if (!strcmp(addressString, "auto")) {
             // assign automatic address
@@ -87,6 +97,11 @@ void LoRaMac::initialize(int stage)
         endListening_1 = new cMessage("Listening_1");
         endDelay_2 = new cMessage("Delay_2");
         endListening_2 = new cMessage("Listening_2");
+        rxWindowTimer = new cMessage("RxWindow");
+        rxWindowEvents[0] = endDelay_1;
+        rxWindowEvents[1] = endListening_1;
+        rxWindowEvents[2] = endDelay_2;
+        rxWindowEvents[3] = endListening_2;
         mediumStateChange = new cMessage("MediumStateChange");
 
         // set up internal queue
@@ -161,7 +176,10 @@ void LoRaMac::configureNetworkInterface()
 void LoRaMac::handleSelfMessage(cMessage *msg)
 {
     EV << "received self message: " << msg << endl;
-    handleWithFsm(msg);
+    if (msg == rxWindowTimer)
+        handleRxWindowTimer();
+    else
+        handleWithFsm(msg);
 }
 #if 0
 void LoRaMac::handleUpperPacket(cMessage *msg)
@@ -271,8 +289,14 @@ void LoRaMac::handleWithFsm(cMessage *msg)
         FSMA_State(WAIT_DELAY_1)
         {
             FSMA_Enter(turnOffReceiver());
+            // the compressed schedule skipped the receive windows, the
+            // receiver stays off until the end of the last one
+            FSMA_Event_Transition(Wait_Delay_1-Idle,
+                                  msg == endListening_2,
+                                  IDLE,
+            );
             FSMA_Event_Transition(Wait_Delay_1-Listening_1,
-                                  msg == endDelay_1 || endDelay_1->isScheduled() == false,
+                                  (msg == endDelay_1 || !isRxWindowEventPending(endDelay_1)) && (!compressedRxWindows || downlinksPossible),
                                   LISTENING_1,
             );
         }
@@ -280,7 +304,7 @@ void LoRaMac::handleWithFsm(cMessage *msg)
         {
             FSMA_Enter(turnOnReceiver());
             FSMA_Event_Transition(Listening_1-Wait_Delay_2,
-                                  msg == endListening_1 || endListening_1->isScheduled() == false,
+                                  msg == endListening_1 || !isRxWindowEventPending(endListening_1),
                                   WAIT_DELAY_2,
             );
             FSMA_Event_Transition(Listening_1-Receiving1,
@@ -299,9 +323,7 @@ void LoRaMac::handleWithFsm(cMessage *msg)
                                   IDLE,
                 sendUp(decapsulate(pkt));
                 numReceived++;
-                cancelEvent(endListening_1);
-                cancelEvent(endDelay_2);
-                cancelEvent(endListening_2);
+                cancelRxWindows();
             );
             FSMA_Event_Transition(Receive-BelowSensitivity,
                                   msg == droppedPacket,
@@ -313,7 +335,7 @@ void LoRaMac::handleWithFsm(cMessage *msg)
         {
             FSMA_Enter(turnOffReceiver());
             FSMA_Event_Transition(Wait_Delay_2-Listening_2,
-                                  msg == endDelay_2 || endDelay_2->isScheduled() == false,
+                                  msg == endDelay_2 || !isRxWindowEventPending(endDelay_2),
                                   LISTENING_2,
             );
         }
@@ -321,7 +343,7 @@ void LoRaMac::handleWithFsm(cMessage *msg)
         {
             FSMA_Enter(turnOnReceiver());
             FSMA_Event_Transition(Listening_2-idle,
-                                  msg == endListening_2 || endListening_2->isScheduled() == false,
+                                  msg == endListening_2 || !isRxWindowEventPending(endListening_2),
                                   IDLE,
             );
             FSMA_Event_Transition(Listening_2-Receiving2,
@@ -340,7 +362,7 @@ void LoRaMac::handleWithFsm(cMessage *msg)
                                   IDLE,
                 sendUp(pkt);
                 numReceived++;
-                cancelEvent(endListening_2);
+                cancelRxWindows();
             );
             FSMA_Event_Transition(Receive2-BelowSensitivity,
                                   msg == droppedPacket,
@@ -497,14 +519,57 @@ void LoRaMac::sendAckFrame()
  */
 void LoRaMac::finishCurrentTransmission()
 {
-    scheduleAt(simTime() + waitDelay1Time, endDelay_1);
-    scheduleAt(simTime() + waitDelay1Time + listening1Time, endListening_1);
-    scheduleAt(simTime() + waitDelay1Time + listening1Time + waitDelay2Time, endDelay_2);
-    scheduleAt(simTime() + waitDelay1Time + listening1Time + waitDelay2Time + listening2Time, endListening_2);
+    if (compressedRxWindows) {
+        rxWindowSchedule[0] = simTime() + waitDelay1Time;
+        rxWindowSchedule[1] = rxWindowSchedule[0] + listening1Time;
+        rxWindowSchedule[2] = rxWindowSchedule[1] + waitDelay2Time;
+        rxWindowSchedule[3] = rxWindowSchedule[2] + listening2Time;
+        // without possible downlinks the node only waits for the end of the
+        // last window with its receiver off
+        rxWindowPhase = downlinksPossible ? 0 : NUM_RX_WINDOW_EVENTS - 1;
+        scheduleAt(rxWindowSchedule[rxWindowPhase], rxWindowTimer);
+    }
+    else {
+        scheduleAt(simTime() + waitDelay1Time, endDelay_1);
+        scheduleAt(simTime() + waitDelay1Time + listening1Time, endListening_1);
+        scheduleAt(simTime() + waitDelay1Time + listening1Time + waitDelay2Time, endDelay_2);
+        scheduleAt(simTime() + waitDelay1Time + listening1Time + waitDelay2Time + listening2Time, endListening_2);
+    }
     deleteCurrentTxFrame();
     //popTxQueue();
 }
 
+void LoRaMac::handleRxWindowTimer()
+{
+    cMessage *event = rxWindowEvents[rxWindowPhase];
+    if (++rxWindowPhase < NUM_RX_WINDOW_EVENTS)
+        scheduleAt(rxWindowSchedule[rxWindowPhase], rxWindowTimer);
+    handleWithFsm(event);
+}
+
+bool LoRaMac::isRxWindowEventPending(cMessage *event) const
+{
+    if (!compressedRxWindows)
+        return event->isScheduled();
+    if (!rxWindowTimer->isScheduled())
+        return false;
+    for (int i = rxWindowPhase; i < NUM_RX_WINDOW_EVENTS; i++)
+        if (rxWindowEvents[i] == event)
+            return true;
+    return false;
+}
+
+void LoRaMac::cancelRxWindows()
+{
+    if (compressedRxWindows)
+        cancelEvent(rxWindowTimer);
+    else {
+        cancelEvent(endListening_1);
+        cancelEvent(endDelay_2);
+        cancelEvent(endListening_2);
+    }
+}
+
 Packet *LoRaMac::getCurrentTransmission()
 {
     ASSERT(currentTxFrame != nullptr);
@@ -43,6 +43,8 @@ class LoRaMac : public MacProtocolBase, public IMacProtocol, public queueing::IA
     simtime_t listening1Time = -1;
     simtime_t waitDelay2Time = -1;
     simtime_t listening2Time = -1;
+    bool compressedRxWindows = false;
+    bool downlinksPossible = true;
     int maxQueueSize = -1;
     int retryLimit = -1;
     int cwMin = -1;
@@ -121,6 +123,18 @@ class LoRaMac : public MacProtocolBase, public IMacProtocol, public queueing::IA
     /** End of the Listening_2 */
     cMessage *endListening_2 = nullptr;
 
+    /**
+     * Single timer walking the receive window schedule in the compressed
+     * mode, where endDelay_1 ... endListening_2 are only handed to the FSM
+     * and never scheduled themselves.
+     */
+    cMessage *rxWindowTimer = nullptr;
+    static const int NUM_RX_WINDOW_EVENTS = 4;
+    cMessage *rxWindowEvents[NUM_RX_WINDOW_EVENTS] = {};
+    simtime_t rxWindowSchedule[NUM_RX_WINDOW_EVENTS];
+    /** Index of the event the rxWindowTimer is scheduled for */
+    int rxWindowPhase = 0;
+
     /** Radio state change self message. Currently this is optimized away and sent directly */
     cMessage *mediumStateChange = nullptr;
     //@}
@@ -195,6 +209,9 @@ class LoRaMac : public MacProtocolBase, public IMacProtocol, public queueing::IA
      */
     //@{
     virtual void finishCurrentTransmission();
+    virtual void handleRxWindowTimer();
+    virtual bool isRxWindowEventPending(cMessage *event) const;
+    virtual void cancelRxWindows();
     virtual Packet *getCurrentTransmission();
 
     virtual bool isReceiving();
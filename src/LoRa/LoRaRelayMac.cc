@@ -5,6 +5,64 @@
  *      Author: handybald
  */
 
+#include "LoRaRelayMac.h"
+#include "LoRaMacFrame_m.h"
+#include "../LoRaPhy/LoRaPhyPreamble_m.h"
+#include "inet/common/ModuleAccess.h"
+#include "inet/common/ProtocolTag_m.h"
+#include "inet/linklayer/common/MacAddressTag_m.h"
 
+namespace lpwan {
 
+Define_Module(LoRaRelayMac);
 
+void LoRaRelayMac::initialize(int stage)
+{
+    MacProtocolBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        radio = check_and_cast<IRadio *>(getModuleFromPar<cModule>(par("radioModule"), this));
+        const char *addressString = par("address");
+        if (!strcmp(addressString, "auto")) {
+            // assign automatic address
+            address = MacAddress::generateAutoAddress();
+            // change module parameter from "auto" to concrete address
+            par("address").setStringValue(address.str().c_str());
+        }
+        else
+            address.setAddress(addressString);
+    }
+    else if (stage == INITSTAGE_LINK_LAYER) {
+        radio->setRadioMode(IRadio::RADIO_MODE_TRANSCEIVER);
+    }
+}
+
+void LoRaRelayMac::configureNetworkInterface()
+{
+    networkInterface->setMacAddress(address);
+    networkInterface->setMtu(par("mtu"));
+    networkInterface->setMulticast(true);
+    networkInterface->setBroadcast(true);
+    networkInterface->setPointToPoint(false);
+}
+
+void LoRaRelayMac::handleUpperMessage(cMessage *msg)
+{
+    auto pkt = check_and_cast<Packet *>(msg);
+    const auto &frame = pkt->peekAtFront<LoRaMacFrame>();
+    pkt->addTagIfAbsent<MacAddressReq>()->setDestAddress(frame->getReceiverAddress());
+    pkt->addTagIfAbsent<PacketProtocolTag>()->setProtocol(&Protocol::apskPhy);
+    sendDown(pkt);
+}
+
+void LoRaRelayMac::handleLowerMessage(cMessage *msg)
+{
+    auto pkt = check_and_cast<Packet *>(msg);
+    pkt->popAtFront<LoRaPhyPreamble>();
+    const auto &frame = pkt->peekAtFront<LoRaMacFrame>();
+    if (frame->getReceiverAddress() == address || frame->getReceiverAddress() == MacAddress::BROADCAST_ADDRESS)
+        sendUp(pkt);
+    else
+        delete pkt;
+}
+
+} /* namespace lpwan */
@@ -8,12 +8,34 @@
 #ifndef LORA_LORARELAYMAC_H_
 #define LORA_LORARELAYMAC_H_
 
+#include "inet/common/INETDefs.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
+#include "inet/linklayer/base/MacProtocolBase.h"
+#include "inet/linklayer/common/MacAddress.h"
+
 namespace lpwan{
 
-class LoRaRelayMac{
+using namespace inet;
+using namespace inet::physicallayer;
+
+/**
+ * MAC of a relay: keeps the radio listening and passes frames between the
+ * radio and the upper layers, frames are only sent up when addressed to the
+ * relay or broadcast. The forwarding itself is done by LoRaRelayRadio.
+ */
+class LoRaRelayMac : public MacProtocolBase {
+
+protected:
+    MacAddress address;
+    IRadio *radio = nullptr;
+
+    virtual void initialize(int stage) override;
+    virtual void configureNetworkInterface() override;
+    virtual void handleUpperMessage(cMessage *msg) override;
+    virtual void handleLowerMessage(cMessage *msg) override;
 
 public:
-    inet::MacAddress getMacAddress();
+    virtual MacAddress getAddress() const { return address; }
 
 };
 } /* namespace lpwan */
@@ -7,6 +7,7 @@
 
 #include "LoRaRelayRadio.h"
 #include "LoRaPhy/LoRaPhyPreamble_m.h"
+#include "LoRaPhy/LoRaSensitivityTable.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/SignalTag_m.h"
 
 namespace lpwan {
@@ -22,14 +23,12 @@ simsignal_t LoRaRelayRadio::droppedPacket = cComponent::registerSignal("droppedP
 void LoRaRelayRadio::initialize(int stage)
 {
     FlatRadioBase::initialize(stage);
-    if (stage == INITSTAGE_LOCAL) {
-        iAmTransmiting = false;
-    }
 }
 
 void LoRaRelayRadio::finish()
 {
     FlatRadioBase::finish();
+    recordScalar("numReceptionsLostToTx", halfDuplex.getNumReceptionsLostToTx());
 }
 
 void LoRaRelayRadio::handleSelfMessage(cMessage *message)
@@ -136,12 +135,15 @@ void LoRaRelayRadio::handleTransmissionTimer(cMessage *message)
 
 void LoRaRelayRadio::startTransmission(Packet *macFrame, IRadioSignal::SignalPart part)
 {
-    if (iAmTransmiting == false)
+    if (!halfDuplex.isTransmitting())
     {
-        iAmTransmiting = true;
-        
         auto radioFrame = createSignal(macFrame);
         auto transmission = radioFrame->getTransmission();
+        int numLost = halfDuplex.startTransmission(transmission->getEndTime());
+        if (numLost > 0)
+        {
+            EV_INFO << "Transmission overlaps " << numLost << " ongoing receptions, they are lost" << endl;
+        }
 
         cMessage *txTimer = new cMessage("transmissionTimer");
         txTimer->setKind(part);
@@ -171,7 +173,7 @@ void LoRaRelayRadio::continueTransmission(cMessage *timer)
 
 void LoRaRelayRadio::endTransmission(cMessage *timer)
 {
-    iAmTransmiting = false;
+    halfDuplex.endTransmission();
     auto part = (IRadioSignal::SignalPart)timer->getKind();
     auto signal = static_cast<WirelessSignal *>(timer->getContextPointer());
     auto transmission = signal->getTransmission();
@@ -202,6 +204,17 @@ bool LoRaRelayRadio::isReceptionTimer(const cMessage *message) const
 //         throw cRuntimeError("Unknown self message");
 // }
 
+bool LoRaRelayRadio::isReceivable(const WirelessSignal *radioFrame) const
+{
+    // no side effects, unlike the reception attempt that evaluates and
+    // reports the collisions of the frame
+    auto transmission = radioFrame->getTransmission();
+    if (!receiver->computeIsReceptionPossible(radioFrame->getListening(), transmission))
+        return false;
+    auto loRaReception = check_and_cast<const LoRaReception *>(radioFrame->getReception());
+    return loRaReception->getPower() >= LoRaSensitivityTable::getSensitivity(loRaReception->getLoRaSF(), loRaReception->getLoRaBW());
+}
+
 void LoRaRelayRadio::startReception(cMessage *timer, IRadioSignal::SignalPart part)
 {
     auto radioFrame = static_cast<WirelessSignal *>(timer->getContextPointer());
@@ -214,7 +227,7 @@ void LoRaRelayRadio::startReception(cMessage *timer, IRadioSignal::SignalPart pa
     {
         LoRaRelayRadioReceptionStarted_counter++;
     }
-    if (isReceiverMode(radioMode) && arrival->getStartTime() == simTime() && iAmTransmiting == false)
+    if (isReceiverMode(radioMode) && arrival->getStartTime() == simTime() && !halfDuplex.isTransmitting())
     {
         auto transmission = radioFrame->getTransmission();
         auto isReceptionAttempted = medium->isReceptionAttempted(this, transmission, part);
@@ -223,10 +236,15 @@ void LoRaRelayRadio::startReception(cMessage *timer, IRadioSignal::SignalPart pa
         {
             concurrentReceptions.push_back(timer);
             receptionTimer = timer;
+            halfDuplex.startReception(timer, arrival->getEndTime());
         }
     }
     else
     {
+        if (halfDuplex.isTransmitting() && isReceivable(radioFrame))
+        {
+            halfDuplex.blockReception();
+        }
         EV_INFO << "LoRaGWRadio Reception started: ignoring " << (WirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(part) << " as " << reception << endl;
     }
     timer->setKind(part);
@@ -250,19 +268,21 @@ void LoRaRelayRadio::continueReception(cMessage *timer)
         if(*it == timer) receptionTimer = timer;
     }
 
-    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime(previousPart) == simTime() && iAmTransmiting == false) {
+    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime(previousPart) == simTime() && !halfDuplex.isTransmitting() && !halfDuplex.isReceptionLost(timer)) {
         auto transmission = radioFrame->getTransmission();
         bool isReceptionSuccessful = medium->isReceptionSuccessful(this, transmission, previousPart);
         EV_INFO << "LoRaRelayRadio Reception ended: " << (isReceptionSuccessful ? "successfully" : "unsuccessfully") << " for " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(previousPart) << " as " << reception << endl;
         if (!isReceptionSuccessful) {
             receptionTimer = nullptr;
             concurrentReceptions.remove(timer);
+            halfDuplex.endReception(timer);
         }
         auto isReceptionAttempted = medium->isReceptionAttempted(this, transmission, nextPart);
         EV_INFO << "LoRaRelayRadio Reception started: " << (isReceptionAttempted ? "attempting" : "not attempting") << " " << (IWirelessSignal *)radioFrame << " " << IRadioSignal::getSignalPartName(nextPart) << " as " << reception << endl;
         if (!isReceptionAttempted) {
             receptionTimer = nullptr;
             concurrentReceptions.remove(timer);
+            halfDuplex.endReception(timer);
         }
     }
     else {
@@ -286,7 +306,7 @@ void LoRaRelayRadio::endReception(cMessage *timer)
     for (it=concurrentReceptions.begin(); it!=concurrentReceptions.end(); it++) {
         if(*it == timer) receptionTimer = timer;
     }
-    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime() == simTime() && iAmTransmiting == false) 
+    if (timer == receptionTimer && isReceiverMode(radioMode) && arrival->getEndTime() == simTime() && !halfDuplex.isTransmitting() && !halfDuplex.isReceptionLost(timer))
     {
         auto transmission = radioFrame->getTransmission();
         // TODO: this would draw twice from the random number generator in isReceptionSuccessful: auto isReceptionSuccessful = medium->isReceptionSuccessful(this, transmission, part);
@@ -310,6 +330,7 @@ void LoRaRelayRadio::endReception(cMessage *timer)
     //updateTransceiverState();
     //updateTransceiverPart();
     radioMode = RADIO_MODE_TRANSCEIVER;
+    halfDuplex.endReception(timer);
     check_and_cast<LoRaMedium *>(medium.get())->emit(IRadioMedium::signalArrivalEndedSignal, check_and_cast<const cObject *>(reception));
     delete timer;
 }
@@ -324,6 +345,7 @@ void LoRaRelayRadio::abortReception(cMessage *timer)
         concurrentReceptions.remove(timer);
         receptionTimer = nullptr;
     }
+    halfDuplex.endReception(timer);
     updateTransceiverState();
     updateTransceiverPart();
 }
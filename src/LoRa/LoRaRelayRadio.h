@@ -21,6 +21,7 @@
 #include "LoRaRelayMacFrame_m.h"
 #include "LoRaTagInfo_m.h"
 #include "LoRaPhy/LoRaMedium.h"
+#include "LoRaHalfDuplexArbiter.h"
 
 
 namespace lpwan {
@@ -46,7 +47,7 @@ protected:
     virtual void handleUpperPacket(Packet *packet) override;
     virtual void handleSignal(WirelessSignal *radioFrame) override;
 
-    bool iAmTransmiting;
+    LoRaHalfDuplexArbiter halfDuplex;
     virtual bool isTransmissionTimer(const cMessage *message) const;
     virtual void handleTransmissionTimer(cMessage *message) override;
     virtual void startTransmission(Packet *macFrame, IRadioSignal::SignalPart part) override;
@@ -57,6 +58,8 @@ protected:
     //TODO: this below and printToStream
     // virtual void LoRaRelayRadio::handleReceptionTimer(cMessage *message) override;
     virtual void startReception(cMessage *timer, IRadioSignal::SignalPart part) override;
+    // whether a frame arriving during a transmission would have been received
+    virtual bool isReceivable(const WirelessSignal *radioFrame) const;
     virtual void continueReception(cMessage *timer) override;
     virtual void endReception(cMessage *timer) override;
     virtual void abortReception(cMessage *timer) override;
@@ -17,6 +17,7 @@
 #include "inet/mobility/static/StationaryMobility.h"
 #include "../LoRa/LoRaTagInfo_m.h"
 #include "inet/common/packet/Packet.h"
+#include "LoRaPhy/LoRaAirtime.h"
 
 
 namespace lpwan {
@@ -73,6 +74,8 @@ void SimpleLoRaApp::initialize(int stage)
         loRaRadio->loRaCR = par("initialLoRaCR");
 //        loRaUseHeader = par("initialUseHeader");
         loRaRadio->loRaUseHeader = par("initialUseHeader");
+        cModule *mac = getParentModule()->getSubmodule("LoRaNic")->getSubmodule("mac");
+        macHeaderLength = mac != nullptr && mac->hasPar("headerLength") ? (int)mac->par("headerLength").intValue() : 0;
         evaluateADRinNode = par("evaluateADRinNode");
         sfVector.setName("SF Vector");
         tpVector.setName("TP Vector");
@@ -115,22 +118,15 @@ void SimpleLoRaApp::handleMessage(cMessage *msg)
             sendJoinRequest();
             if (simTime() >= getSimulation()->getWarmupPeriod())
                 sentPackets++;
-            delete msg;
             if(numberOfPacketsToSend == 0 || sentPackets < numberOfPacketsToSend)
             {
-                double time;
-                int loRaSF = getSF();
-                if(loRaSF == 7) time = 7.808;
-                if(loRaSF == 8) time = 13.9776;
-                if(loRaSF == 9) time = 24.6784;
-                if(loRaSF == 10) time = 49.3568;
-                if(loRaSF == 11) time = 85.6064;
-                if(loRaSF == 12) time = 171.2128;
+                // the 1% duty cycle keeps the channel free for 99 times the
+                // time on air of the packet just sent
+                double time = 100 * LoRaAirtime::getTimeOnAir(lastSentDataSize + macHeaderLength, getSF(), getBW().get(), getCR(), loRaRadio->loRaUseHeader);
                 do {
                     timeToNextPacket = par("timeToNextPacket");
                     //if(timeToNextPacket < 3) error("Time to next packet must be grater than 3");
                 } while(timeToNextPacket <= time);
-                sendMeasurements = new cMessage("sendMeasurements");
                 scheduleAt(simTime() + timeToNextPacket, sendMeasurements);
             }
         }
@@ -185,7 +181,8 @@ void SimpleLoRaApp::sendJoinRequest()
     pktRequest->setKind(DATA);
 
     auto payload = makeShared<LoRaAppPacket>();
-    payload->setChunkLength(B(par("dataSize").intValue()));
+    lastSentDataSize = par("dataSize").intValue();
+    payload->setChunkLength(B(lastSentDataSize));
 
     lastSentMeasurement = rand();
     payload->setSampleMeasurement(lastSentMeasurement);
@@ -52,11 +52,14 @@ class SimpleLoRaApp : public cSimpleModule, public ILifecycle
         int sentPackets;
         int receivedADRCommands;
         int lastSentMeasurement;
+        int lastSentDataSize = 0;
+        int macHeaderLength = 0;
         simtime_t timeToFirstPacket;
         simtime_t timeToNextPacket;
 
         cMessage *configureLoRaParameters;
-        cMessage *sendMeasurements;
+        // reused for every packet
+        cMessage *sendMeasurements = nullptr;
 
         //history of sent packets;
         cOutVector sfVector;
@@ -87,6 +90,7 @@ class SimpleLoRaApp : public cSimpleModule, public ILifecycle
 
     public:
         SimpleLoRaApp() {}
+        virtual ~SimpleLoRaApp() { cancelAndDelete(sendMeasurements); }
         simsignal_t LoRa_AppPacketSent;
 
 };
@@ -56,6 +56,8 @@ void LoRaEnergyConsumer::initialize(int stage)
         //radioModule->subscribe(EpEnergyStorageBase::residualEnergyCapacityChangedSignal, this);
         //radioModule->subscribe(IdealEpEnergyStorage::residualEnergyCapacityChangedSignal, this);
         radio = check_and_cast<IRadio *>(radioModule);
+        loRaRadio = dynamic_cast<LoRaRadio *>(radioModule);
+        analyticIdle = par("analyticIdle");
 
         energySource.reference(this, "energySourceModule", true);
 
@@ -146,6 +148,10 @@ void LoRaEnergyConsumer::receiveSignal(cComponent *source, simsignal_t signal, i
         signal == IRadio::transmittedSignalPartChangedSignal)
     {
         powerConsumption = getPowerConsumption();
+        // nothing is drawn before and after, the interval adds no energy and
+        // the update is left to the next change, only the emit is saved
+        if (analyticIdle && powerConsumption == W(0) && lastPowerConsumption == W(0) && lastEnergyBalanceUpdate >= 0)
+            return;
         emit(powerConsumptionChangedSignal, powerConsumption.get());
 
         simtime_t currentSimulationTime = simTime();
@@ -176,7 +182,7 @@ W LoRaEnergyConsumer::getPowerConsumption() const
     if (radioMode == IRadio::RADIO_MODE_RECEIVER) {
         powerConsumption += mW(supplyVoltage*receiverBusySupplyCurrent);
     } else if (radioMode == IRadio::RADIO_MODE_TRANSMITTER) {
-        LoRaRadio *radio = check_and_cast<LoRaRadio *>(getParentModule());
+        LoRaRadio *radio = loRaRadio != nullptr ? loRaRadio : check_and_cast<LoRaRadio *>(getParentModule());
         auto current = transmitterTransmittingSupplyCurrent.find(radio->loRaTP);
         powerConsumption += mW(supplyVoltage*current->second);
     } else {
@@ -20,6 +20,7 @@
 #include "inet/power/storage/IdealEpEnergyStorage.h"
 #include <map>
 #include "inet/common/ModuleAccess.h"
+#include "LoRa/LoRaRadio.h"
 
 using namespace inet;
 
@@ -39,6 +40,8 @@ protected:
     J energyBalance = J(NaN);
     simtime_t lastEnergyBalanceUpdate = -1;
     W lastPowerConsumption = W(0);
+    bool analyticIdle = false;
+    LoRaRadio *loRaRadio = nullptr;
     // All supply currents to be define in mA
     double receiverReceivingSupplyCurrent;
     double receiverBusySupplyCurrent;
@@ -0,0 +1,55 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_ILORAPATHLOSS_H_
+#define LORAPHY_ILORAPATHLOSS_H_
+
+#include "inet/common/geometry/common/Coord.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/ITransmission.h"
+#include <cstddef>
+
+using namespace inet;
+using namespace inet::physicallayer;
+
+namespace lpwan {
+
+/**
+ * Path loss models whose random shadowing can be drawn separately from the
+ * deterministic part, so that the loss of many links can be evaluated in one
+ * batch.
+ */
+class ILoRaPathLoss
+{
+  public:
+    virtual ~ILoRaPathLoss() {}
+
+    /**
+     * Returns the shadowing in dB of the link between the transmitter and the
+     * receiver at the given position.
+     */
+    virtual double computeShadowing(const ITransmission *transmission, const IRadio *receiver, const Coord& receiverPosition) const = 0;
+
+    /**
+     * Computes the linear path loss of count links from their distances in
+     * meters and shadowings in dB. The result is identical to the scalar
+     * computePathLoss given the same shadowing sample.
+     */
+    virtual void computePathLosses(const double *distances, const double *shadowings, double *pathLosses, size_t count) const = 0;
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_ILORAPATHLOSS_H_ */
@@ -0,0 +1,88 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAAIRTIME_H_
+#define LORAPHY_LORAAIRTIME_H_
+
+namespace lpwan {
+
+/**
+ * Time on air of a LoRa frame, following the Semtech SX1272/73 datasheet,
+ * section 4.1.1.7. A frame consists of the preamble (the programmed number of
+ * symbols plus 4.25 sync symbols), the first block of 8 symbols sent at code
+ * rate 4/8 that carries the explicit header, and the rest of the payload.
+ * Durations are in seconds, bandwidths in Hz, and code rates are 1..4 for
+ * 4/5..4/8. Low data rate optimization is used when the symbol duration
+ * reaches 16 ms, as mandated by LoRaWAN.
+ */
+class LoRaAirtime
+{
+  public:
+    static constexpr int DEFAULT_PREAMBLE_SYMBOLS = 8;
+    static constexpr int HEADER_SYMBOLS = 8;
+
+  public:
+    static constexpr double getSymbolDuration(int spreadingFactor, double bandwidth)
+    {
+        return (1 << spreadingFactor) / bandwidth;
+    }
+
+    static constexpr bool isLowDataRateOptimized(int spreadingFactor, double bandwidth)
+    {
+        return getSymbolDuration(spreadingFactor, bandwidth) >= 0.016;
+    }
+
+    static constexpr double getPreambleDuration(int spreadingFactor, double bandwidth, int preambleSymbols = DEFAULT_PREAMBLE_SYMBOLS)
+    {
+        return (preambleSymbols + 4.25) * getSymbolDuration(spreadingFactor, bandwidth);
+    }
+
+    /**
+     * Returns the number of symbols after the preamble, including the first
+     * block of 8 symbols.
+     */
+    static constexpr int getPayloadSymbols(int payloadBytes, int spreadingFactor, int codeRate, bool explicitHeader, bool crc, bool lowDataRate)
+    {
+        return HEADER_SYMBOLS + ceilDivide(8 * payloadBytes - 4 * spreadingFactor + 28 + (crc ? 16 : 0) - (explicitHeader ? 0 : 20), 4 * (spreadingFactor - (lowDataRate ? 2 : 0))) * (codeRate + 4);
+    }
+
+    static constexpr double getHeaderDuration(int spreadingFactor, double bandwidth)
+    {
+        return HEADER_SYMBOLS * getSymbolDuration(spreadingFactor, bandwidth);
+    }
+
+    /**
+     * Returns the duration of the payload symbols following the first block.
+     */
+    static constexpr double getDataDuration(int payloadBytes, int spreadingFactor, double bandwidth, int codeRate, bool explicitHeader = true, bool crc = true)
+    {
+        return (getPayloadSymbols(payloadBytes, spreadingFactor, codeRate, explicitHeader, crc, isLowDataRateOptimized(spreadingFactor, bandwidth)) - HEADER_SYMBOLS) * getSymbolDuration(spreadingFactor, bandwidth);
+    }
+
+    static constexpr double getTimeOnAir(int payloadBytes, int spreadingFactor, double bandwidth, int codeRate, bool explicitHeader = true, bool crc = true, int preambleSymbols = DEFAULT_PREAMBLE_SYMBOLS)
+    {
+        return getPreambleDuration(spreadingFactor, bandwidth, preambleSymbols) + getHeaderDuration(spreadingFactor, bandwidth) + getDataDuration(payloadBytes, spreadingFactor, bandwidth, codeRate, explicitHeader, crc);
+    }
+
+  protected:
+    static constexpr int ceilDivide(int numerator, int denominator)
+    {
+        return numerator > 0 ? (numerator + denominator - 1) / denominator : 0;
+    }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORAAIRTIME_H_ */
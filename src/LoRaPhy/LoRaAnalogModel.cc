@@ -17,10 +17,16 @@
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarAnalogModel.h"
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarReception.h"
+#include "inet/physicallayer/wireless/common/pathloss/NakagamiFading.h"
+#include "inet/physicallayer/wireless/common/pathloss/RayleighFading.h"
+#include "inet/physicallayer/wireless/common/pathloss/RicianFading.h"
 #include "LoRaReception.h"
 #include "LoRaTransmission.h"
 #include "LoRaReceiver.h"
 #include "LoRa/LoRaRadio.h"
+#include "LoRaMedium.h"
+#include "LoRaSensitivityTable.h"
+#include "LoRaChannelPlanListening.h"
 
 namespace lpwan {
 
@@ -32,75 +38,79 @@ std::ostream& LoRaAnalogModel::printToStream(std::ostream& stream, int level, in
 }
 
 const W LoRaAnalogModel::getBackgroundNoisePower(const LoRaBandListening *listening) const {
-    //const LoRaBandListening *loRaListening = check_and_cast<const LoRaBandListening *>(listening);
     //Sensitivity values from Semtech SX1272/73 datasheet, table 10, Rev 3.1, March 2017
-    W noisePower = W(math::dBmW2mW(-126.5) / 1000);
-    if(listening->getLoRaSF() == 6)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-121) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-118) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-111) / 1000);
+    if (auto planListening = dynamic_cast<const LoRaChannelPlanListening *>(listening)) {
+        // every channel of the plan contributes its own noise, the plan
+        // listens on every SF so the floor of the most sensitive one is used
+        W noisePower = W(0);
+        for (const auto& channel : planListening->getChannelPlan()->getChannels())
+            noisePower += LoRaSensitivityTable::getSensitivity(LoRaSensitivityTable::MAX_SF, channel.bandwidth);
+        return noisePower;
     }
+    return LoRaSensitivityTable::getSensitivity(listening->getLoRaSF(), listening->getLoRaBW());
+}
 
-    if (listening->getLoRaSF() == 7)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-124) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-122) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-116) / 1000);
+void LoRaAnalogModel::initialize(int stage)
+{
+    ScalarAnalogModelBase::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        staticTopology = par("staticTopology");
+        if (staticTopology)
+            checkDeterministicPathLoss();
     }
+}
 
-    if(listening->getLoRaSF() == 8)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-127) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-125) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-119) / 1000);
-    }
-    if(listening->getLoRaSF() == 9)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-130) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-128) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-122) / 1000);
-    }
-    if(listening->getLoRaSF() == 10)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-133) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-130) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-125) / 1000);
-    }
-    if(listening->getLoRaSF() == 11)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-135) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-132) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-128) / 1000);
-    }
-    if(listening->getLoRaSF() == 12)
-    {
-        if(listening->getLoRaBW() == Hz(125000)) noisePower = W(math::dBmW2mW(-137) / 1000);
-        if(listening->getLoRaBW() == Hz(250000)) noisePower = W(math::dBmW2mW(-135) / 1000);
-        if(listening->getLoRaBW() == Hz(500000)) noisePower = W(math::dBmW2mW(-129) / 1000);
-    }
-    return noisePower;
+void LoRaAnalogModel::checkDeterministicPathLoss() const
+{
+    // a memoized random path loss would freeze its first draw for the whole run
+    cModule *pathLossModule = getParentModule()->getSubmodule("pathLoss");
+    if (pathLossModule == nullptr)
+        return;
+    bool cachedShadowing = pathLossModule->hasPar("cachedShadowing") && pathLossModule->par("cachedShadowing").boolValue();
+    bool randomShadowing = pathLossModule->hasPar("sigma") && pathLossModule->par("sigma").doubleValue() != 0 && !cachedShadowing;
+    bool fading = dynamic_cast<NakagamiFading *>(pathLossModule) != nullptr || dynamic_cast<RayleighFading *>(pathLossModule) != nullptr || dynamic_cast<RicianFading *>(pathLossModule) != nullptr;
+    if (randomShadowing || fading)
+        throw cRuntimeError("The staticTopology parameter requires a deterministic path loss, %s draws it randomly (use cachedShadowing = true or sigma = 0)", pathLossModule->getNedTypeName());
 }
 
-W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
+double LoRaAnalogModel::computeLinkGain(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
 {
     const IRadioMedium *radioMedium = receiverRadio->getMedium();
 //    const IRadio *transmitterRadio = transmission->getTransmitter();
 //    const IAntenna *receiverAntenna = receiverRadio->getAntenna();
 //    const IAntenna *transmitterAntenna = transmitterRadio->getAntenna();
     const INarrowbandSignal *narrowbandSignalAnalogModel = check_and_cast<const INarrowbandSignal *>(transmission->getAnalogModel());
-    const IScalarSignal *scalarSignalAnalogModel = check_and_cast<const IScalarSignal *>(transmission->getAnalogModel());
     const Coord receptionStartPosition = arrival->getStartPosition();
-    const Coord receptionEndPosition = arrival->getEndPosition();
 //    const Quaternion transmissionDirection = computeTransmissionDirection(transmission, arrival);
 //    const Quaternion transmissionAntennaDirection = transmission->getStartOrientation() - transmissionDirection;
 //    const Quaternion receptionAntennaDirection = transmissionDirection - arrival->getStartOrientation();
     double transmitterAntennaGain = computeAntennaGain(transmission->getTransmitterAntennaGain(), transmission->getStartPosition(), arrival->getStartPosition(), transmission->getStartOrientation());
     double receiverAntennaGain = computeAntennaGain(receiverRadio->getAntenna()->getGain().get(), arrival->getStartPosition(), transmission->getStartPosition(), arrival->getStartOrientation());
-    double pathLoss = radioMedium->getPathLoss()->computePathLoss(transmission, arrival);
+    const LoRaMedium *loRaMedium = dynamic_cast<const LoRaMedium *>(radioMedium);
+    double pathLoss;
+    if (loRaMedium == nullptr || !loRaMedium->getBatchedPathLoss(receiverRadio, transmission, receptionStartPosition, pathLoss))
+        pathLoss = radioMedium->getPathLoss()->computePathLoss(transmission, arrival);
     double obstacleLoss = radioMedium->getObstacleLoss() ? radioMedium->getObstacleLoss()->computeObstacleLoss(narrowbandSignalAnalogModel->getCenterFrequency(), transmission->getStartPosition(), receptionStartPosition) : 1;
+    return std::min(1.0, transmitterAntennaGain * receiverAntennaGain * pathLoss * obstacleLoss);
+}
+
+W LoRaAnalogModel::computeReceptionPower(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
+{
+    const IScalarSignal *scalarSignalAnalogModel = check_and_cast<const IScalarSignal *>(transmission->getAnalogModel());
     W transmissionPower = scalarSignalAnalogModel->getPower();
-    return transmissionPower * std::min(1.0, transmitterAntennaGain * receiverAntennaGain * pathLoss * obstacleLoss);
+    if (!staticTopology)
+        return transmissionPower * computeLinkGain(receiverRadio, transmission, arrival);
+    if (!staticTopologyChecked) {
+        mps maxSpeed = receiverRadio->getMedium()->getMediumLimitCache()->getMaxSpeed();
+        if (maxSpeed != mps(0))
+            throw cRuntimeError("The staticTopology parameter requires that no radio moves, maximum speed is %g mps", maxSpeed.get());
+        staticTopologyChecked = true;
+    }
+    uint64_t key = ((uint64_t)(uint32_t)transmission->getTransmitterId() << 32) | (uint32_t)receiverRadio->getId();
+    auto it = linkGains.find(key);
+    if (it == linkGains.end())
+        it = linkGains.insert({key, computeLinkGain(receiverRadio, transmission, arrival)}).first;
+    return transmissionPower * it->second;
 }
 
 const IReception *LoRaAnalogModel::computeReception(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
@@ -120,14 +130,17 @@ const IReception *LoRaAnalogModel::computeReception(const IRadio *receiverRadio,
     return new LoRaReception(receiverRadio, transmission, receptionStartTime, receptionEndTime, receptionStartPosition, receptionEndPosition, receptionStartOrientation, receptionEndOrientation, LoRaCF, LoRaBW, receivedPower, LoRaSF, LoRaCR);
 }
 
-const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const IInterference *interference) const
+void LoRaAnalogModel::computeNoiseEdges(const IListening *listening, const IInterference *interference, simtime_t& noiseStartTime, simtime_t& noiseEndTime) const
 {
     const LoRaBandListening *bandListening = check_and_cast<const LoRaBandListening *>(listening);
+    // a plan listening hears the sum of its channels, it spans the whole plan
+    // so its own band would partially overlap every signal on a channel
+    const LoRaChannelPlanListening *planListening = dynamic_cast<const LoRaChannelPlanListening *>(listening);
     Hz commonCarrierFrequency = bandListening->getLoRaCF();
     Hz commonBandwidth = bandListening->getLoRaBW();
-    simtime_t noiseStartTime = SimTime::getMaxTime();
-    simtime_t noiseEndTime = 0;
-    std::map<simtime_t, W> *powerChanges = new std::map<simtime_t, W>();
+    noiseStartTime = SimTime::getMaxTime();
+    noiseEndTime = 0;
+    noiseEdges.clear();
     const std::vector<const IReception *> *interferingReceptions = interference->getInterferingReceptions();
     for (auto reception : *interferingReceptions) {
         const ISignalAnalogModel *signalAnalogModel = reception->getAnalogModel();
@@ -135,7 +148,8 @@ const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const I
         const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(signalAnalogModel);
         Hz signalCarrierFrequency = loRaReception->getLoRaCF();
         Hz signalBandwidth = loRaReception->getLoRaBW();
-        if((commonCarrierFrequency == signalCarrierFrequency && commonBandwidth == signalBandwidth))
+        bool isListenedSignal = planListening != nullptr ? planListening->isListeningTo(signalCarrierFrequency, signalBandwidth) : commonCarrierFrequency == signalCarrierFrequency && commonBandwidth == signalBandwidth;
+        if (isListenedSignal)
         {
             const IScalarSignal *scalarSignalAnalogModel = check_and_cast<const IScalarSignal *>(signalAnalogModel);
             W power = scalarSignalAnalogModel->getPower();
@@ -145,34 +159,44 @@ const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const I
                 noiseStartTime = startTime;
             if (endTime > noiseEndTime)
                 noiseEndTime = endTime;
-            std::map<simtime_t, W>::iterator itStartTime = powerChanges->find(startTime);
-            if (itStartTime != powerChanges->end())
-                itStartTime->second += power;
-            else
-                powerChanges->insert(std::pair<simtime_t, W>(startTime, power));
-            std::map<simtime_t, W>::iterator itEndTime = powerChanges->find(endTime);
-            if (itEndTime != powerChanges->end())
-                itEndTime->second -= power;
-            else
-                powerChanges->insert(std::pair<simtime_t, W>(endTime, -power));
+            noiseEdges.emplace_back(startTime, power);
+            noiseEdges.emplace_back(endTime, -power);
+        }
+        else if (planListening != nullptr) {
+            for (const auto& channel : planListening->getChannelPlan()->getChannels())
+                if (areOverlappingBands(channel.centerFrequency, channel.bandwidth, narrowbandSignalAnalogModel->getCenterFrequency(), narrowbandSignalAnalogModel->getBandwidth()))
+                    throw cRuntimeError("Overlapping bands are not supported");
         }
         else if (areOverlappingBands(commonCarrierFrequency, commonBandwidth, narrowbandSignalAnalogModel->getCenterFrequency(), narrowbandSignalAnalogModel->getBandwidth()))
             throw cRuntimeError("Overlapping bands are not supported");
     }
 
-    simtime_t startTime = listening->getStartTime();
-    simtime_t endTime = listening->getEndTime();
-    std::map<simtime_t, W> *backgroundNoisePowerChanges = new std::map<simtime_t, W>();
     const W noisePower = getBackgroundNoisePower(bandListening);
-    backgroundNoisePowerChanges->insert(std::pair<simtime_t, W>(startTime, noisePower));
-    backgroundNoisePowerChanges->insert(std::pair<simtime_t, W>(endTime, -noisePower));
+    noiseEdges.emplace_back(listening->getStartTime(), noisePower);
+    noiseEdges.emplace_back(listening->getEndTime(), -noisePower);
+
+    // stable, so edges at the same time are summed in the same order as they
+    // were added, background noise last
+    std::stable_sort(noiseEdges.begin(), noiseEdges.end(), [] (const std::pair<simtime_t, W>& a, const std::pair<simtime_t, W>& b) {
+        return a.first < b.first;
+    });
+}
+
+const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const IInterference *interference) const
+{
+    const LoRaBandListening *bandListening = check_and_cast<const LoRaBandListening *>(listening);
+    simtime_t noiseStartTime;
+    simtime_t noiseEndTime;
+    computeNoiseEdges(listening, interference, noiseStartTime, noiseEndTime);
 
-    for (const auto & backgroundNoisePowerChange : *backgroundNoisePowerChanges) {
-        std::map<simtime_t, W>::iterator jt = powerChanges->find(backgroundNoisePowerChange.first);
-        if (jt != powerChanges->end())
-            jt->second += backgroundNoisePowerChange.second;
+    // the noise takes ownership of the power changes, edges are coalesced by
+    // time and appended at the end
+    std::map<simtime_t, W> *powerChanges = new std::map<simtime_t, W>();
+    for (const auto& edge : noiseEdges) {
+        if (!powerChanges->empty() && powerChanges->rbegin()->first == edge.first)
+            powerChanges->rbegin()->second += edge.second;
         else
-            powerChanges->insert(std::pair<simtime_t, W>(backgroundNoisePowerChange.first, backgroundNoisePowerChange.second));
+            powerChanges->emplace_hint(powerChanges->end(), edge.first, edge.second);
     }
 
     EV_TRACE << "Noise power begin " << endl;
@@ -182,7 +206,31 @@ const INoise *LoRaAnalogModel::computeNoise(const IListening *listening, const I
         EV_TRACE << "Noise at " << it->first << " = " << noise << endl;
     }
     EV_TRACE << "Noise power end" << endl;
-    return new ScalarNoise(noiseStartTime, noiseEndTime, commonCarrierFrequency, commonBandwidth, powerChanges);
+    return new ScalarNoise(noiseStartTime, noiseEndTime, bandListening->getLoRaCF(), bandListening->getLoRaBW(), powerChanges);
+}
+
+void LoRaAnalogModel::computeNoisePowerRange(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime, W& minPower, W& maxPower) const
+{
+    simtime_t noiseStartTime;
+    simtime_t noiseEndTime;
+    computeNoiseEdges(listening, interference, noiseStartTime, noiseEndTime);
+    minPower = W(NaN);
+    maxPower = W(NaN);
+    W noisePower = W(0);
+    for (size_t i = 0; i < noiseEdges.size(); i++) {
+        noisePower += noiseEdges[i].second;
+        // sample after every edge at the same time has been applied
+        if (i + 1 < noiseEdges.size() && noiseEdges[i + 1].first == noiseEdges[i].first)
+            continue;
+        if (noiseEdges[i].first >= endTime)
+            break;
+        if (noiseEdges[i].first >= startTime) {
+            if (std::isnan(minPower.get()) || noisePower < minPower)
+                minPower = noisePower;
+            if (std::isnan(maxPower.get()) || noisePower > maxPower)
+                maxPower = noisePower;
+        }
+    }
 }
 
 const ISnir *LoRaAnalogModel::computeSNIR(const IReception *reception, const INoise *noise) const
@@ -21,17 +21,45 @@
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarNoise.h"
 
 #include "LoRaBandListening.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace lpwan {
 
 class LoRaAnalogModel : public ScalarAnalogModelBase
 {
+  protected:
+    bool staticTopology = false;
+    mutable bool staticTopologyChecked = false;
+    /**
+     * Link gains keyed on the transmitter id in the upper and the receiver id
+     * in the lower 32 bits.
+     */
+    mutable std::unordered_map<uint64_t, double> linkGains;
+    /**
+     * Power changes of the last noise computation sorted by time, reused
+     * between calls so that computing the noise doesn't allocate.
+     */
+    mutable std::vector<std::pair<simtime_t, W>> noiseEdges;
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void checkDeterministicPathLoss() const;
+    virtual void computeNoiseEdges(const IListening *listening, const IInterference *interference, simtime_t& noiseStartTime, simtime_t& noiseEndTime) const;
+    virtual double computeLinkGain(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const;
+
   public:
     const W getBackgroundNoisePower(const LoRaBandListening *listening) const;
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
     virtual W computeReceptionPower(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival) const override;
     virtual const IReception *computeReception(const IRadio *radio, const ITransmission *transmission, const IArrival *arrival) const override;
     const INoise *computeNoise(const IListening *listening, const IInterference *interference) const override;
+    /**
+     * Computes the minimum and maximum noise power over [startTime, endTime)
+     * without building the noise power function.
+     */
+    virtual void computeNoisePowerRange(const IListening *listening, const IInterference *interference, simtime_t startTime, simtime_t endTime, W& minPower, W& maxPower) const;
     virtual const ISnir *computeSNIR(const IReception *reception, const INoise *noise) const override;
 };
 
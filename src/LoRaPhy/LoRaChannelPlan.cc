@@ -0,0 +1,60 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaChannelPlan.h"
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace lpwan {
+
+void LoRaChannelPlan::parse(const char *text)
+{
+    channels.clear();
+    for (auto& token : cStringTokenizer(text).asVector()) {
+        size_t separator = token.find('/');
+        if (separator == std::string::npos)
+            throw cRuntimeError("Invalid channel '%s' in channel plan, expected center frequency/bandwidth", token.c_str());
+        LoRaChannel channel;
+        channel.centerFrequency = Hz(cNedValue::parseQuantity(token.substr(0, separator).c_str(), "Hz"));
+        channel.bandwidth = Hz(cNedValue::parseQuantity(token.substr(separator + 1).c_str(), "Hz"));
+        if (!(channel.centerFrequency > Hz(0)) || !(channel.bandwidth > Hz(0)))
+            throw cRuntimeError("Invalid channel '%s' in channel plan", token.c_str());
+        channels.push_back(channel);
+    }
+    if (channels.empty()) {
+        centerFrequency = Hz(NaN);
+        bandwidth = Hz(NaN);
+        return;
+    }
+    Hz lower = channels[0].centerFrequency - channels[0].bandwidth / 2;
+    Hz upper = channels[0].centerFrequency + channels[0].bandwidth / 2;
+    for (const auto& channel : channels) {
+        lower = std::min(lower, channel.centerFrequency - channel.bandwidth / 2);
+        upper = std::max(upper, channel.centerFrequency + channel.bandwidth / 2);
+    }
+    centerFrequency = (lower + upper) / 2;
+    bandwidth = upper - lower;
+}
+
+bool LoRaChannelPlan::contains(Hz centerFrequency, Hz bandwidth) const
+{
+    for (const auto& channel : channels)
+        if (channel.centerFrequency == centerFrequency && channel.bandwidth == bandwidth)
+            return true;
+    return false;
+}
+
+} // namespace lpwan
@@ -0,0 +1,65 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORACHANNELPLAN_H_
+#define LORAPHY_LORACHANNELPLAN_H_
+
+#include "inet/common/Units.h"
+#include <vector>
+
+using namespace inet;
+using namespace inet::units::values;
+
+namespace lpwan {
+
+struct LoRaChannel
+{
+    Hz centerFrequency;
+    Hz bandwidth;
+};
+
+/**
+ * Set of channels a multi-channel receiver, such as the concentrator of a
+ * gateway, demodulates on every spreading factor.
+ */
+class LoRaChannelPlan
+{
+  protected:
+    std::vector<LoRaChannel> channels;
+    Hz centerFrequency = Hz(NaN);
+    Hz bandwidth = Hz(NaN);
+
+  public:
+    /**
+     * Parses a space separated list of center frequency/bandwidth pairs,
+     * e.g. "868.1MHz/125kHz 868.3MHz/125kHz 868.5MHz/125kHz". An empty
+     * string gives an empty plan.
+     */
+    void parse(const char *text);
+
+    bool isEmpty() const { return channels.empty(); }
+    const std::vector<LoRaChannel>& getChannels() const { return channels; }
+    bool contains(Hz centerFrequency, Hz bandwidth) const;
+
+    /**
+     * Returns the center and the width of the band spanned by all channels.
+     */
+    Hz getCenterFrequency() const { return centerFrequency; }
+    Hz getBandwidth() const { return bandwidth; }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORACHANNELPLAN_H_ */
@@ -0,0 +1,38 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaChannelPlanListening.h"
+
+namespace lpwan {
+
+// the spreading factor of the band listening is 0, every one is listened to
+LoRaChannelPlanListening::LoRaChannelPlanListening(const IRadio *radio, simtime_t startTime, simtime_t endTime, Coord startPosition, Coord endPosition, const LoRaChannelPlan *channelPlan) :
+    LoRaBandListening(radio, startTime, endTime, startPosition, endPosition, channelPlan->getCenterFrequency(), channelPlan->getBandwidth(), 0),
+    channelPlan(channelPlan)
+{
+}
+
+std::ostream& LoRaChannelPlanListening::printToStream(std::ostream& stream, int level, int evFlags) const
+{
+    stream << "LoRaChannelPlanListening";
+    if (level <= PRINT_LEVEL_DETAIL) {
+        stream << ", channels =";
+        for (const auto& channel : channelPlan->getChannels())
+            stream << " " << channel.centerFrequency << "/" << channel.bandwidth;
+    }
+    return ListeningBase::printToStream(stream, level, evFlags);
+}
+
+} // namespace lpwan
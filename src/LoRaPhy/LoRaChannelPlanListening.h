@@ -0,0 +1,46 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORACHANNELPLANLISTENING_H_
+#define LORAPHY_LORACHANNELPLANLISTENING_H_
+
+#include "LoRaBandListening.h"
+#include "LoRaChannelPlan.h"
+
+namespace lpwan {
+
+/**
+ * Listening on every spreading factor of the channels of a channel plan. As
+ * a band listening it spans the whole plan, so that energy detection and
+ * the interference lookup cover every channel of it. The plan is owned by
+ * the receiver.
+ */
+class LoRaChannelPlanListening : public LoRaBandListening
+{
+  protected:
+    const LoRaChannelPlan *channelPlan;
+
+  public:
+    LoRaChannelPlanListening(const IRadio *radio, simtime_t startTime, simtime_t endTime, Coord startPosition, Coord endPosition, const LoRaChannelPlan *channelPlan);
+
+    virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
+
+    const LoRaChannelPlan *getChannelPlan() const { return channelPlan; }
+    bool isListeningTo(Hz centerFrequency, Hz bandwidth) const { return channelPlan->contains(centerFrequency, bandwidth); }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORACHANNELPLANLISTENING_H_ */
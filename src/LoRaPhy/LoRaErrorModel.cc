@@ -0,0 +1,58 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaErrorModel.h"
+#include "LoRaModulation.h"
+#include "LoRaReception.h"
+
+namespace lpwan {
+
+Define_Module(LoRaErrorModel);
+
+static bps computeBitRate(int spreadFactor, Hz bandwidth)
+{
+    // one symbol carries SF bits during 2^SF / BW
+    return bps(spreadFactor * bandwidth.get() / pow(2, spreadFactor));
+}
+
+std::ostream& LoRaErrorModel::printToStream(std::ostream& stream, int level, int evFlags) const
+{
+    return stream << "LoRaErrorModel";
+}
+
+double LoRaErrorModel::computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    double bitErrorRate = computeBitErrorRate(snir, part);
+    if (bitErrorRate == 0)
+        return 0;
+    b length = snir->getReception()->getTransmission()->getPacket()->getTotalLength();
+    return 1 - pow(1 - bitErrorRate, length.get());
+}
+
+double LoRaErrorModel::computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(snir->getReception());
+    LoRaModulation modulation(loRaReception->getLoRaSF(), loRaReception->getLoRaBW(), computeBitRate(loRaReception->getLoRaSF(), loRaReception->getLoRaBW()), 1, loRaReception->getLoRaCR());
+    return modulation.calculateBER(snir->getMin(), modulation.getBandwith(), modulation.getbitRate());
+}
+
+double LoRaErrorModel::computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const
+{
+    const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(snir->getReception());
+    LoRaModulation modulation(loRaReception->getLoRaSF(), loRaReception->getLoRaBW(), computeBitRate(loRaReception->getLoRaSF(), loRaReception->getLoRaBW()), 1, loRaReception->getLoRaCR());
+    return modulation.calculateSER(snir->getMin(), modulation.getBandwith(), modulation.getbitRate());
+}
+
+} // namespace lpwan
@@ -0,0 +1,43 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAERRORMODEL_H_
+#define LORAPHY_LORAERRORMODEL_H_
+
+#include "inet/physicallayer/wireless/common/base/packetlevel/ErrorModelBase.h"
+
+namespace lpwan {
+
+using namespace inet;
+using namespace inet::physicallayer;
+
+/**
+ * Error model of LoRa chirp spread spectrum receptions. The bit and symbol
+ * error rates come from LoRaModulation for the spreading factor, bandwidth
+ * and code rate of the reception, evaluated at its minimum SNIR.
+ */
+class LoRaErrorModel : public ErrorModelBase
+{
+  public:
+    virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
+
+    virtual double computePacketErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+    virtual double computeBitErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+    virtual double computeSymbolErrorRate(const ISnir *snir, IRadioSignal::SignalPart part) const override;
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORAERRORMODEL_H_ */
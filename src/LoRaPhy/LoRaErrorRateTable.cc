@@ -0,0 +1,137 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaErrorRateTable.h"
+#include "inet/common/INETMath.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace lpwan {
+
+using namespace inet;
+
+constexpr int LoRaErrorRateTable::MIN_SF;
+constexpr int LoRaErrorRateTable::MAX_SF;
+constexpr int LoRaErrorRateTable::MIN_CR;
+constexpr int LoRaErrorRateTable::MAX_CR;
+constexpr double LoRaErrorRateTable::MIN_SNIR_DB;
+constexpr double LoRaErrorRateTable::MAX_SNIR_DB;
+constexpr double LoRaErrorRateTable::SNIR_STEP_DB;
+constexpr int LoRaErrorRateTable::NUM_SAMPLES;
+
+static const int NUM_SPREADING_FACTORS = LoRaErrorRateTable::MAX_SF - LoRaErrorRateTable::MIN_SF + 1;
+static const int NUM_CODE_RATES = LoRaErrorRateTable::MAX_CR - LoRaErrorRateTable::MIN_CR + 1;
+
+static double q(double x)
+{
+    return 0.5 * std::erfc(x / std::sqrt(2.0));
+}
+
+double LoRaErrorRateTable::computeUncodedBitErrorRate(int spreadingFactor, double snir)
+{
+    double ebN0 = snir * std::pow(2.0, spreadingFactor) / spreadingFactor;
+    return q(std::log(spreadingFactor) / std::log(12.0) / std::sqrt(2.0) * ebN0);
+}
+
+double LoRaErrorRateTable::computeBitErrorRate(int spreadingFactor, int codeRate, double snir)
+{
+    double p = computeUncodedBitErrorRate(spreadingFactor, snir);
+    if (codeRate < 3)
+        return p;
+    // Hamming (4 + codeRate, 4) corrects a single bit error per codeword
+    int n = 4 + codeRate;
+    double ber = 0;
+    for (int i = 2; i <= n; i++)
+        ber += i * math::n_choose_k(n, i) * std::pow(p, i) * std::pow(1 - p, n - i);
+    return ber / n;
+}
+
+double LoRaErrorRateTable::computeSymbolErrorRate(int spreadingFactor, double snir)
+{
+    double m = std::pow(2.0, spreadingFactor);
+    return std::min(1.0, computeUncodedBitErrorRate(spreadingFactor, snir) * 2 * (m - 1) / m);
+}
+
+typedef std::vector<double> Samples;
+
+template<typename F>
+static Samples computeSamples(F f)
+{
+    Samples samples(LoRaErrorRateTable::NUM_SAMPLES);
+    for (int i = 0; i < LoRaErrorRateTable::NUM_SAMPLES; i++)
+        samples[i] = f(math::dB2fraction(LoRaErrorRateTable::MIN_SNIR_DB + i * LoRaErrorRateTable::SNIR_STEP_DB));
+    return samples;
+}
+
+static int clampSpreadingFactor(int spreadingFactor)
+{
+    return std::max(LoRaErrorRateTable::MIN_SF, std::min(LoRaErrorRateTable::MAX_SF, spreadingFactor));
+}
+
+static int clampCodeRate(int codeRate)
+{
+    return std::max(LoRaErrorRateTable::MIN_CR, std::min(LoRaErrorRateTable::MAX_CR, codeRate));
+}
+
+const double *LoRaErrorRateTable::getBitErrorRates(int spreadingFactor, int codeRate)
+{
+    static std::array<Samples, NUM_SPREADING_FACTORS * NUM_CODE_RATES> tables;
+    spreadingFactor = clampSpreadingFactor(spreadingFactor);
+    codeRate = clampCodeRate(codeRate);
+    Samples& table = tables[(spreadingFactor - MIN_SF) * NUM_CODE_RATES + codeRate - MIN_CR];
+    if (table.empty())
+        table = computeSamples([=] (double snir) { return computeBitErrorRate(spreadingFactor, codeRate, snir); });
+    return table.data();
+}
+
+const double *LoRaErrorRateTable::getSymbolErrorRates(int spreadingFactor)
+{
+    static std::array<Samples, NUM_SPREADING_FACTORS> tables;
+    spreadingFactor = clampSpreadingFactor(spreadingFactor);
+    Samples& table = tables[spreadingFactor - MIN_SF];
+    if (table.empty())
+        table = computeSamples([=] (double snir) { return computeSymbolErrorRate(spreadingFactor, snir); });
+    return table.data();
+}
+
+double LoRaErrorRateTable::interpolate(const double *table, double snir)
+{
+    double position = (10 * std::log10(snir) - MIN_SNIR_DB) / SNIR_STEP_DB;
+    position = std::max(0.0, std::min(NUM_SAMPLES - 1.0, position));
+    int index = std::min((int)position, NUM_SAMPLES - 2);
+    double fraction = position - index;
+    return table[index] + fraction * (table[index + 1] - table[index]);
+}
+
+double LoRaErrorRateTable::getBitErrorRate(int spreadingFactor, int codeRate, double snir)
+{
+    return interpolate(getBitErrorRates(spreadingFactor, codeRate), snir);
+}
+
+double LoRaErrorRateTable::getSymbolErrorRate(int spreadingFactor, double snir)
+{
+    return interpolate(getSymbolErrorRates(spreadingFactor), snir);
+}
+
+void LoRaErrorRateTable::getBitErrorRates(int spreadingFactor, int codeRate, const double *snirs, double *bitErrorRates, size_t count)
+{
+    const double *table = getBitErrorRates(spreadingFactor, codeRate);
+    for (size_t i = 0; i < count; i++)
+        bitErrorRates[i] = interpolate(table, snirs[i]);
+}
+
+} // namespace lpwan
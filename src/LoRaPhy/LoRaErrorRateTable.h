@@ -0,0 +1,80 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAERRORRATETABLE_H_
+#define LORAPHY_LORAERRORRATETABLE_H_
+
+#include <cstddef>
+
+namespace lpwan {
+
+/**
+ * Bit and symbol error rates of LoRa chirp spread spectrum modulation per
+ * spreading factor and code rate (1..4 for 4/5..4/8), as a function of the
+ * SNIR measured in the signal bandwidth.
+ *
+ * The uncoded bit error rate is the closed form approximation of
+ * Elshabrawy and Robert, "Closed-Form Approximation of LoRa Modulation BER
+ * Performance", IEEE Communications Letters, 2018:
+ * BER = Q(log12(SF) / sqrt(2) * Eb/N0) with Eb/N0 = SNIR * 2^SF / SF. The
+ * symbol error rate follows from the orthogonal signaling relation
+ * SER = BER * 2 * (M - 1) / M with M = 2^SF. Code rates 4/7 and 4/8 correct
+ * one bit per Hamming codeword, assuming independent bit errors; code rates
+ * 4/5 and 4/6 only detect errors and leave the bit error rate unchanged.
+ *
+ * The lookups interpolate linearly in tables sampled every 0.1 dB, which
+ * are computed on first use per spreading factor and code rate.
+ */
+class LoRaErrorRateTable
+{
+  public:
+    static constexpr int MIN_SF = 6;
+    static constexpr int MAX_SF = 12;
+    static constexpr int MIN_CR = 1;
+    static constexpr int MAX_CR = 4;
+    static constexpr double MIN_SNIR_DB = -30;
+    static constexpr double MAX_SNIR_DB = 10;
+    static constexpr double SNIR_STEP_DB = 0.1;
+    static constexpr int NUM_SAMPLES = 401;
+
+  protected:
+    static const double *getBitErrorRates(int spreadingFactor, int codeRate);
+    static const double *getSymbolErrorRates(int spreadingFactor);
+    static double interpolate(const double *table, double snir);
+
+  public:
+    /** @name Closed form error rates, used to fill the tables. */
+    //@{
+    static double computeUncodedBitErrorRate(int spreadingFactor, double snir);
+    static double computeBitErrorRate(int spreadingFactor, int codeRate, double snir);
+    static double computeSymbolErrorRate(int spreadingFactor, double snir);
+    //@}
+
+    /** @name Table lookups, out of range SNIRs are clamped to the table. */
+    //@{
+    static double getBitErrorRate(int spreadingFactor, int codeRate, double snir);
+    static double getSymbolErrorRate(int spreadingFactor, double snir);
+    /**
+     * Fills bitErrorRates with the bit error rate of each of the count SNIR
+     * samples. The loop has no data dependent branches, so the index
+     * computation vectorizes.
+     */
+    static void getBitErrorRates(int spreadingFactor, int codeRate, const double *snirs, double *bitErrorRates, size_t count);
+    //@}
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORAERRORRATETABLE_H_ */
@@ -0,0 +1,63 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaInterferenceIndex.h"
+#include <algorithm>
+
+namespace lpwan {
+
+void LoRaInterferenceIndex::addRadio(const IRadio *radio)
+{
+    radioToPartitions[radio];
+}
+
+void LoRaInterferenceIndex::removeRadio(const IRadio *radio)
+{
+    radioToPartitions.erase(radio);
+}
+
+void LoRaInterferenceIndex::addInterval(const IRadio *radio, Hz centerFrequency, Hz bandwidth, simtime_t startTime, simtime_t endTime, const ITransmission *transmission)
+{
+    auto& partitions = radioToPartitions[radio];
+    auto it = std::find_if(partitions.begin(), partitions.end(), [&] (const Partition& partition) {
+        return partition.centerFrequency == centerFrequency && partition.bandwidth == bandwidth;
+    });
+    if (it == partitions.end()) {
+        Partition partition;
+        partition.centerFrequency = centerFrequency;
+        partition.bandwidth = bandwidth;
+        partitions.push_back(partition);
+        it = partitions.end() - 1;
+    }
+    Interval interval;
+    interval.startTime = startTime;
+    interval.endTime = endTime;
+    interval.transmission = transmission;
+    it->intervals.push_back(interval);
+}
+
+void LoRaInterferenceIndex::removeIntervalsEndingBefore(simtime_t time)
+{
+    for (auto& elem : radioToPartitions) {
+        for (auto& partition : elem.second) {
+            auto& intervals = partition.intervals;
+            intervals.erase(std::remove_if(intervals.begin(), intervals.end(), [&] (const Interval& interval) {
+                return interval.endTime <= time;
+            }), intervals.end());
+        }
+    }
+}
+
+} // namespace lpwan
@@ -0,0 +1,102 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORAINTERFERENCEINDEX_H_
+#define LORAPHY_LORAINTERFERENCEINDEX_H_
+
+#include "inet/common/Units.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/ITransmission.h"
+#include <unordered_map>
+#include <vector>
+
+using namespace inet;
+using namespace inet::units::values;
+using namespace inet::physicallayer;
+
+namespace lpwan {
+
+/**
+ * Arrival intervals of the ongoing transmissions per receiver radio,
+ * partitioned by channel (center frequency and bandwidth). A query only
+ * visits the partitions whose band overlaps the queried band, so receptions
+ * on other channels of a multi-channel deployment are never looked at.
+ * Partitions only hold the few transmissions that are still interfering,
+ * hence they are plain vectors scanned linearly.
+ */
+class LoRaInterferenceIndex
+{
+  protected:
+    struct Interval
+    {
+        simtime_t startTime;
+        simtime_t endTime;
+        const ITransmission *transmission;
+    };
+
+    struct Partition
+    {
+        Hz centerFrequency;
+        Hz bandwidth;
+        std::vector<Interval> intervals;
+    };
+
+    std::unordered_map<const IRadio *, std::vector<Partition>> radioToPartitions;
+
+  protected:
+    static bool areOverlappingBands(Hz centerFrequency1, Hz bandwidth1, Hz centerFrequency2, Hz bandwidth2)
+    {
+        return std::abs(centerFrequency1.get() - centerFrequency2.get()) < (bandwidth1.get() + bandwidth2.get()) / 2;
+    }
+
+  public:
+    void addRadio(const IRadio *radio);
+    void removeRadio(const IRadio *radio);
+
+    /**
+     * Records that the transmission arrives at the radio during the given
+     * interval on the given channel.
+     */
+    void addInterval(const IRadio *radio, Hz centerFrequency, Hz bandwidth, simtime_t startTime, simtime_t endTime, const ITransmission *transmission);
+
+    /**
+     * Drops the intervals whose end time is not after the given time. Must be
+     * called with a time for which every transmission removed from the medium
+     * satisfies this, because the index doesn't own the transmissions.
+     */
+    void removeIntervalsEndingBefore(simtime_t time);
+
+    /**
+     * Calls f for every transmission arriving at the radio that overlaps the
+     * [startTime, endTime] interval on a band overlapping the given one.
+     */
+    template<typename F> void mapInterferingTransmissions(const IRadio *radio, Hz centerFrequency, Hz bandwidth, simtime_t startTime, simtime_t endTime, F f) const
+    {
+        auto it = radioToPartitions.find(radio);
+        if (it == radioToPartitions.end())
+            return;
+        for (const auto& partition : it->second) {
+            if (!std::isnan(centerFrequency.get()) && !areOverlappingBands(centerFrequency, bandwidth, partition.centerFrequency, partition.bandwidth))
+                continue;
+            for (const auto& interval : partition.intervals)
+                if (interval.startTime <= endTime && interval.endTime >= startTime)
+                    f(interval.transmission);
+        }
+    }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORAINTERFERENCEINDEX_H_ */
@@ -31,6 +31,9 @@ void LoRaLogNormalShadowing::initialize(int stage)
         sigma = par("sigma");
         gamma = par("gamma");
         d0 = m(par("d0"));
+        cachedShadowing = par("cachedShadowing");
+        cachedShadowingResolution = m(par("cachedShadowingResolution"));
+        cachedShadowingSeed = par("cachedShadowingSeed").intValue();
     }
 }
 
@@ -40,16 +43,96 @@ std::ostream& LoRaLogNormalShadowing::printToStream(std::ostream& stream, int le
     if (level <= PRINT_LEVEL_TRACE)
         stream << ", alpha = " << alpha
                << ", systemLoss = " << systemLoss
-               << ", sigma = " << sigma;
+               << ", sigma = " << sigma
+               << ", cachedShadowing = " << cachedShadowing;
     return stream;
 }
 
+static uint64_t splitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+size_t LoRaLogNormalShadowing::LinkKeyHash::operator()(const LinkKey& key) const
+{
+    uint64_t hash = splitMix64(key.transmitterId);
+    hash = splitMix64(hash ^ key.x);
+    hash = splitMix64(hash ^ key.y);
+    return splitMix64(hash ^ key.z);
+}
+
+double LoRaLogNormalShadowing::computeLinkShadowing(const LinkKey& key) const
+{
+    // Box-Muller on two uniforms derived from the link, independent of the RNGs
+    uint64_t hash = splitMix64(LinkKeyHash()(key) ^ cachedShadowingSeed);
+    double u1 = ((hash >> 11) + 1) / 9007199254740992.0;
+    double u2 = (splitMix64(hash) >> 11) / 9007199254740992.0;
+    return sigma * std::sqrt(-2 * std::log(u1)) * std::cos(2 * M_PI * u2);
+}
+
+LoRaLogNormalShadowing::LinkKey LoRaLogNormalShadowing::computeLinkKey(const ITransmission *transmission, const Coord& receiverPosition) const
+{
+    double resolution = cachedShadowingResolution.get();
+    LinkKey key;
+    key.transmitterId = transmission->getTransmitterId();
+    key.x = (int64_t)std::floor(receiverPosition.x / resolution);
+    key.y = (int64_t)std::floor(receiverPosition.y / resolution);
+    key.z = (int64_t)std::floor(receiverPosition.z / resolution);
+    return key;
+}
+
+double LoRaLogNormalShadowing::computeShadowing(const ITransmission *transmission, const IRadio *receiver, const Coord& receiverPosition) const
+{
+    if (!cachedShadowing)
+        return normal(0.0, sigma);
+    LinkKey key = computeLinkKey(transmission, receiverPosition);
+    uint64_t pair = ((uint64_t)(uint32_t)key.transmitterId << 32) | (uint32_t)receiver->getId();
+    auto it = linkToShadowing.find(pair);
+    if (it == linkToShadowing.end())
+        it = linkToShadowing.insert({pair, {key, computeLinkShadowing(key)}}).first;
+    else if (!(it->second.key == key)) {
+        // the receiver moved to another cell
+        it->second.key = key;
+        it->second.shadowing = computeLinkShadowing(key);
+    }
+    return it->second.shadowing;
+}
+
+double LoRaLogNormalShadowing::computePathLoss(const ITransmission *transmission, const IArrival *arrival) const
+{
+    // the arrival doesn't know its receiver, the value only depends on the
+    // link key so it is computed without the pair cache
+    double distance = arrival->getStartPosition().distance(transmission->getStartPosition());
+    double shadowing = cachedShadowing ? computeLinkShadowing(computeLinkKey(transmission, arrival->getStartPosition())) : normal(0.0, sigma);
+    return computePathLoss(distance, shadowing);
+}
+
 double LoRaLogNormalShadowing::computePathLoss(mps propagationSpeed, Hz frequency, m distance) const
 {
-    // parameters taken from paper "Do LoRa Low-Power Wide-Area Networks Scale?"
+    // without the link there is no cached value to use, a fresh draw would
+    // give the link a different shadowing than the other entry points
+    if (cachedShadowing)
+        throw cRuntimeError("LoRaLogNormalShadowing with cachedShadowing can only compute the path loss of a link, the distance alone is not enough");
+    return computePathLoss(distance.get(), normal(0.0, sigma));
+}
+
+void LoRaLogNormalShadowing::computePathLosses(const double *distances, const double *shadowings, double *pathLosses, size_t count) const
+{
+    // the same operations in the same order as the scalar computePathLoss,
+    // split into passes with a single math call each so that every loop maps
+    // to the vector variants of log10 and pow (e.g. glibc libmvec)
     double PL_d0_db = 127.41;
-    double PL_db = PL_d0_db + 10 * gamma * log10(unit(distance / d0).get()) + normal(0.0, sigma);
-    return math::dB2fraction(-PL_db);
+    double slope = 10 * gamma;
+    double distance0 = d0.get();
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = log10(distances[i] / distance0);
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = -(PL_d0_db + slope * pathLosses[i] + shadowings[i]) / 10;
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = pow(10.0, pathLosses[i]);
 }
 
 m LoRaLogNormalShadowing::computeRange(W transmissionPower) const
@@ -17,6 +17,9 @@
 #define LORAPHY_LORALOGNORMALSHADOWING_H_
 
 #include "inet/physicallayer/wireless/common/pathloss/FreeSpacePathLoss.h"
+#include "inet/common/INETMath.h"
+#include "LoRaPhy/ILoRaPathLoss.h"
+#include <unordered_map>
 
 using namespace inet;
 using namespace inet::physicallayer;
@@ -25,21 +28,63 @@ namespace lpwan {
 /**
  * This class implements the log normal shadowing model.
  */
-class LoRaLogNormalShadowing : public FreeSpacePathLoss
+class LoRaLogNormalShadowing : public FreeSpacePathLoss, public ILoRaPathLoss
 {
   protected:
     m d0;
     double gamma;
     double sigma;
+    /**
+     * When set, every link gets a single shadowing value that is derived from
+     * the transmitter id, the quantized receiver position and the seed, so it
+     * doesn't depend on the order of the events either.
+     */
+    bool cachedShadowing;
+    m cachedShadowingResolution;
+    uint64_t cachedShadowingSeed;
+
+    struct LinkKey
+    {
+        int transmitterId;
+        int64_t x, y, z;
+        bool operator==(const LinkKey& other) const { return transmitterId == other.transmitterId && x == other.x && y == other.y && z == other.z; }
+    };
+    struct LinkKeyHash
+    {
+        size_t operator()(const LinkKey& key) const;
+    };
+    /**
+     * Shadowing of the (transmitter, receiver) pairs at the receiver cell it
+     * was computed for, replaced when the receiver moves to another cell, so
+     * there is at most one entry per pair.
+     */
+    struct CachedShadowing
+    {
+        LinkKey key;
+        double shadowing;
+    };
+    mutable std::unordered_map<uint64_t, CachedShadowing> linkToShadowing;
 
   protected:
     virtual void initialize(int stage) override;
+    virtual double computeLinkShadowing(const LinkKey& key) const;
+    virtual LinkKey computeLinkKey(const ITransmission *transmission, const Coord& receiverPosition) const;
+
+    double computePathLoss(double distance, double shadowing) const
+    {
+        // parameters taken from paper "Do LoRa Low-Power Wide-Area Networks Scale?"
+        double PL_d0_db = 127.41;
+        double PL_db = PL_d0_db + 10 * gamma * log10(distance / d0.get()) + shadowing;
+        return math::dB2fraction(-PL_db);
+    }
 
   public:
     LoRaLogNormalShadowing();
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
-    //virtual double computePathLoss(const ITransmission *transmission, const IArrival *arrival) const override;
+    virtual double computePathLoss(const ITransmission *transmission, const IArrival *arrival) const override;
     virtual double computePathLoss(mps propagationSpeed, Hz frequency, m distance) const override;
+    virtual double computeShadowing(const ITransmission *transmission, const IRadio *receiver, const Coord& receiverPosition) const override;
+    virtual void computePathLosses(const double *distances, const double *shadowings, double *pathLosses, size_t count) const override;
     m computeRange(W transmissionPower) const;
 };
 
@@ -15,6 +15,7 @@
 #include "LoRaMedium.h"
 #include "../LoRa/LoRaMacFrame_m.h"
 #include "LoRaBandListening.h"
+#include "LoRaReception.h"
 #include "LoRaTransmission.h"
 #include "inet/common/INETUtils.h"
 #include "inet/common/ModuleAccess.h"
@@ -42,6 +43,37 @@ LoRaMedium::~LoRaMedium()
 {
 }
 
+void LoRaMedium::initialize(int stage)
+{
+    RadioMedium::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        lazyArrivals = par("lazyArrivals");
+        batchPathLoss = par("batchPathLoss");
+        loRaPathLoss = dynamic_cast<const ILoRaPathLoss *>(pathLoss);
+        if (batchPathLoss && loRaPathLoss == nullptr)
+            throw cRuntimeError("The batchPathLoss parameter requires a path loss model with separate shadowing, such as LoRaLogNormalShadowing");
+        errorModel = dynamic_cast<IErrorModel *>(getSubmodule("errorModel"));
+    }
+}
+
+void LoRaMedium::handleMessage(cMessage *message)
+{
+    RadioMedium::handleMessage(message);
+    if (message == removeNonInterferingTransmissionsTimer) {
+        // every transmission just removed has all of its arrivals ending at
+        // least the maximum transmission duration before now
+        interferenceIndex.removeIntervalsEndingBefore(simTime() - mediumLimitCache->getMaxTransmissionDuration());
+        for (auto it = transmissionToPathLosses.begin(); it != transmissionToPathLosses.end(); ) {
+            if (it->second.interferenceEndTime <= simTime()) {
+                freePathLosses.push_back(std::move(it->second.pathLosses));
+                it = transmissionToPathLosses.erase(it);
+            }
+            else
+                it++;
+        }
+    }
+}
+
 bool LoRaMedium::matchesMacAddressFilter(const IRadio *radio, const Packet *packet) const
 {
     const auto &chunk = packet->peekAtFront<Chunk>();
@@ -72,20 +104,30 @@ const IReceptionResult *LoRaMedium::getReceptionResult(const IRadio *radio, cons
     else {
         result = computeReceptionResult(radio, listening, transmission);
 
+        // LoRa receivers add both indications themselves, the SNIR is only
+        // looked up for receivers that don't, and at most once
         auto pkt = const_cast<Packet *>(result->getPacket());
+        const ISnir *snir = nullptr;
         if (!pkt->findTag<SnirInd>()) {
-            const ISnir *snir = getSNIR(radio, transmission);
-            auto snirInd = pkt->addTagIfAbsent<SnirInd>();
+            snir = getSNIR(radio, transmission);
+            auto snirInd = pkt->addTag<SnirInd>();
             snirInd->setMinimumSnir(snir->getMin());
             snirInd->setMaximumSnir(snir->getMax());
         }
         if (!pkt->findTag<ErrorRateInd>()) {
-            auto errorModel = dynamic_cast<IErrorModel *>(getSubmodule("errorModel"));
-            const ISnir *snir = getSNIR(radio, transmission);
-            auto errorRateInd = pkt->addTagIfAbsent<ErrorRateInd>(); // TODO: should be done  setPacketErrorRate(packetModel->getPER());
-            errorRateInd->setPacketErrorRate(errorModel ? errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-            errorRateInd->setBitErrorRate(errorModel ? errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-            errorRateInd->setSymbolErrorRate(errorModel ? errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
+            auto errorRateInd = pkt->addTag<ErrorRateInd>(); // TODO: should be done  setPacketErrorRate(packetModel->getPER());
+            if (errorModel) {
+                if (snir == nullptr)
+                    snir = getSNIR(radio, transmission);
+                errorRateInd->setPacketErrorRate(errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+                errorRateInd->setBitErrorRate(errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+                errorRateInd->setSymbolErrorRate(errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+            }
+            else {
+                errorRateInd->setPacketErrorRate(0.0);
+                errorRateInd->setBitErrorRate(0.0);
+                errorRateInd->setSymbolErrorRate(0.0);
+            }
         }
 
         communicationCache->setCachedReceptionResult(radio, transmission, result);
@@ -94,27 +136,203 @@ const IReceptionResult *LoRaMedium::getReceptionResult(const IRadio *radio, cons
     return result;
 }
 
+void LoRaMedium::addRadio(const IRadio *radio)
+{
+    // the medium limit cache reads the table when the radio is added
+    radioTable.addRadio(radio);
+    RadioMedium::addRadio(radio);
+    interferenceIndex.addRadio(radio);
+    IMobility *mobility = radio->getAntenna()->getMobility();
+    spatialGrid.addRadio(radio, mobility->getCurrentPosition());
+    auto& radios = mobilityToRadios[mobility];
+    if (radios.empty())
+        check_and_cast<cModule *>(mobility)->subscribe(IMobility::mobilityStateChangedSignal, this);
+    radios.push_back(radio);
+}
+
+void LoRaMedium::removeRadio(const IRadio *radio)
+{
+    radioTable.removeRadio(radio);
+    RadioMedium::removeRadio(radio);
+    interferenceIndex.removeRadio(radio);
+    spatialGrid.removeRadio(radio);
+    IMobility *mobility = radio->getAntenna()->getMobility();
+    auto it = mobilityToRadios.find(mobility);
+    if (it != mobilityToRadios.end()) {
+        auto& radios = it->second;
+        radios.erase(std::remove(radios.begin(), radios.end(), radio), radios.end());
+        if (radios.empty()) {
+            check_and_cast<cModule *>(mobility)->unsubscribe(IMobility::mobilityStateChangedSignal, this);
+            mobilityToRadios.erase(it);
+        }
+    }
+}
+
+void LoRaMedium::receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details)
+{
+    if (signal == IMobility::mobilityStateChangedSignal) {
+        Enter_Method_Silent();
+        IMobility *mobility = check_and_cast<IMobility *>(value);
+        auto it = mobilityToRadios.find(mobility);
+        if (it != mobilityToRadios.end()) {
+            Coord position = mobility->getCurrentPosition();
+            for (auto radio : it->second)
+                spatialGrid.updateRadio(radio, position);
+        }
+    }
+    else
+        RadioMedium::receiveSignal(source, signal, value, details);
+}
+
+const IArrival *LoRaMedium::getArrival(const IRadio *receiver, const ITransmission *transmission) const
+{
+    const IArrival *arrival = communicationCache->getCachedArrival(receiver, transmission);
+    if (arrival == nullptr) {
+        // either the receiver was outside the interference range when the
+        // transmission was added or the arrival was deferred in lazy mode
+        arrival = propagation->computeArrival(transmission, receiver->getAntenna()->getMobility());
+        communicationCache->setCachedArrival(receiver, transmission, arrival);
+    }
+    return arrival;
+}
+
+const IListening *LoRaMedium::getListening(const IRadio *receiver, const ITransmission *transmission) const
+{
+    const IListening *listening = communicationCache->getCachedListening(receiver, transmission);
+    if (listening == nullptr) {
+        listening = createListening(receiver, transmission, getArrival(receiver, transmission));
+        communicationCache->setCachedListening(receiver, transmission, listening);
+    }
+    return listening;
+}
+
+const IListening *LoRaMedium::createListening(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const
+{
+    const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
+    return new LoRaBandListening(receiverRadio, arrival->getStartTime(), arrival->getEndTime(), arrival->getStartPosition(), arrival->getEndPosition(), loRaTransmission->getLoRaCF(), loRaTransmission->getLoRaBW(), loRaTransmission->getLoRaSF());
+}
+
+bool LoRaMedium::getBatchedPathLoss(const IRadio *receiver, const ITransmission *transmission, const Coord& receiverPosition, double& pathLoss) const
+{
+    auto it = transmissionToPathLosses.find(transmission);
+    if (it == transmissionToPathLosses.end())
+        return false;
+    const std::vector<BatchedPathLoss>& pathLosses = it->second.pathLosses;
+    BatchedPathLoss key;
+    key.receiver = receiver;
+    auto jt = std::lower_bound(pathLosses.begin(), pathLosses.end(), key);
+    // a lazily computed arrival of a moving receiver may be at another
+    // position than the one the batch used
+    if (jt == pathLosses.end() || jt->receiver != receiver || jt->receiverPosition != receiverPosition)
+        return false;
+    pathLoss = jt->pathLoss;
+    return true;
+}
+
+void LoRaMedium::computeBatchedPathLosses(const ITransmission *transmission)
+{
+    size_t count = batchReceivers.size();
+    const Coord& transmitterPosition = transmission->getStartPosition();
+    batchDistances.resize(count);
+    batchShadowings.resize(count);
+    batchPathLosses.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        batchDistances[i] = batchPositions[i].distance(transmitterPosition);
+        batchShadowings[i] = loRaPathLoss->computeShadowing(transmission, batchReceivers[i], batchPositions[i]);
+    }
+    loRaPathLoss->computePathLosses(batchDistances.data(), batchShadowings.data(), batchPathLosses.data(), count);
+    BatchedPathLosses& batchedPathLosses = transmissionToPathLosses[transmission];
+    batchedPathLosses.interferenceEndTime = communicationCache->getCachedInterferenceEndTime(transmission);
+    std::vector<BatchedPathLoss>& pathLosses = batchedPathLosses.pathLosses;
+    if (!freePathLosses.empty()) {
+        pathLosses = std::move(freePathLosses.back());
+        freePathLosses.pop_back();
+    }
+    pathLosses.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        pathLosses[i].receiver = batchReceivers[i];
+        pathLosses[i].receiverPosition = batchPositions[i];
+        pathLosses[i].pathLoss = batchPathLosses[i];
+    }
+    std::sort(pathLosses.begin(), pathLosses.end());
+}
+
+void LoRaMedium::addArrival(const IRadio *receiverRadio, const ITransmission *transmission, simtime_t& maxArrivalEndTime)
+{
+    const IArrival *arrival = propagation->computeArrival(transmission, receiverRadio->getAntenna()->getMobility());
+    const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
+    const simtime_t arrivalEndTime = arrival->getEndTime();
+    if (arrivalEndTime > maxArrivalEndTime)
+        maxArrivalEndTime = arrivalEndTime;
+    interferenceIndex.addInterval(receiverRadio, loRaTransmission->getLoRaCF(), loRaTransmission->getLoRaBW(), arrival->getStartTime(), arrivalEndTime, transmission);
+    if (batchPathLoss) {
+        // the path loss is computed at the arrival position, like the scalar path
+        batchReceivers.push_back(receiverRadio);
+        batchPositions.push_back(arrival->getStartPosition());
+    }
+    if (lazyArrivals)
+        // only the arrival times are needed for the interference interval,
+        // the rest is computed when the receiver asks for it
+        delete arrival;
+    else {
+        communicationCache->setCachedArrival(receiverRadio, transmission, arrival);
+        communicationCache->setCachedListening(receiverRadio, transmission, createListening(receiverRadio, transmission, arrival));
+    }
+}
+
+std::vector<const IReception *> *LoRaMedium::computeInterferingReceptions(const IListening *listening) const
+{
+    const IRadio *radio = listening->getReceiver();
+    // listenings other than LoRa band listenings see every channel
+    const LoRaBandListening *loRaListening = dynamic_cast<const LoRaBandListening *>(listening);
+    Hz centerFrequency = loRaListening != nullptr ? loRaListening->getLoRaCF() : Hz(NaN);
+    Hz bandwidth = loRaListening != nullptr ? loRaListening->getLoRaBW() : Hz(NaN);
+    std::vector<const IReception *> *interferingReceptions = new std::vector<const IReception *>();
+    interferenceIndex.mapInterferingTransmissions(radio, centerFrequency, bandwidth, listening->getStartTime(), listening->getEndTime(), [&] (const ITransmission *interferingTransmission) {
+        if (isInterferingTransmission(interferingTransmission, listening))
+            interferingReceptions->push_back(getReception(radio, interferingTransmission));
+    });
+    return interferingReceptions;
+}
+
+std::vector<const IReception *> *LoRaMedium::computeInterferingReceptions(const IReception *reception) const
+{
+    const IRadio *radio = reception->getReceiver();
+    const ITransmission *transmission = reception->getTransmission();
+    const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(reception);
+    std::vector<const IReception *> *interferingReceptions = new std::vector<const IReception *>();
+    interferenceIndex.mapInterferingTransmissions(radio, loRaReception->getLoRaCF(), loRaReception->getLoRaBW(), reception->getStartTime(), reception->getEndTime(), [&] (const ITransmission *interferingTransmission) {
+        if (interferingTransmission != transmission && isInterferingTransmission(interferingTransmission, reception))
+            interferingReceptions->push_back(getReception(radio, interferingTransmission));
+    });
+    return interferingReceptions;
+}
+
 void LoRaMedium::addTransmission(const IRadio *transmitterRadio, const ITransmission *transmission)
 {
     Enter_Method("addTransmission");
     transmissionCount++;
     communicationCache->addTransmission(transmission);
     simtime_t maxArrivalEndTime = transmission->getEndTime();
-    communicationCache->mapRadios([&] (const IRadio *receiverRadio) {
-        if (receiverRadio != nullptr && receiverRadio != transmitterRadio && receiverRadio->getReceiver() != nullptr) {
-            const IArrival *arrival = propagation->computeArrival(transmission, receiverRadio->getAntenna()->getMobility());
-            const IntervalTree::Interval *interval = new IntervalTree::Interval(arrival->getStartTime(), arrival->getEndTime(), (void *)transmission);
-            const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
-            LoRaBandListening *loraListening = new LoRaBandListening(receiverRadio, arrival->getStartTime(), arrival->getEndTime(), arrival->getStartPosition(), arrival->getEndPosition(), loRaTransmission->getLoRaCF(), loRaTransmission->getLoRaBW(), loRaTransmission->getLoRaSF());
-            const simtime_t arrivalEndTime = arrival->getEndTime();
-            if (arrivalEndTime > maxArrivalEndTime)
-                maxArrivalEndTime = arrivalEndTime;
-            communicationCache->setCachedArrival(receiverRadio, transmission, arrival);
-            communicationCache->setCachedInterval(receiverRadio, transmission, interval);
-            communicationCache->setCachedListening(receiverRadio, transmission, loraListening);
-        }
-    });
+    batchReceivers.clear();
+    batchPositions.clear();
+    auto addArrivalIfReceiver = [&] (const IRadio *receiverRadio) {
+        if (receiverRadio != nullptr && receiverRadio != transmitterRadio && receiverRadio->getReceiver() != nullptr)
+            addArrival(receiverRadio, transmission, maxArrivalEndTime);
+    };
+    // only radios in the cells around the transmitter can be interfered with,
+    // an unbounded (NaN or infinite) range falls back to visiting every radio
+    double interferenceRange = mediumLimitCache->getMaxInterferenceRange().get();
+    if (std::isnan(interferenceRange) || std::isinf(interferenceRange) || interferenceRange <= 0)
+        radioTable.mapRadios(addArrivalIfReceiver);
+    else {
+        if (spatialGrid.getCellSize() != interferenceRange)
+            spatialGrid.setCellSize(interferenceRange);
+        spatialGrid.mapRadios(transmission->getStartPosition(), interferenceRange, addArrivalIfReceiver);
+    }
     communicationCache->setCachedInterferenceEndTime(transmission, maxArrivalEndTime + mediumLimitCache->getMaxTransmissionDuration());
+    if (batchPathLoss)
+        computeBatchedPathLosses(transmission);
     if (!removeNonInterferingTransmissionsTimer->isScheduled())
         scheduleAt(communicationCache->getCachedInterferenceEndTime(transmission), removeNonInterferingTransmissionsTimer);
     emit(signalAddedSignal, check_and_cast<const cObject *>(transmission));
@@ -25,10 +25,18 @@
 #include "inet/physicallayer/wireless/common/medium/CommunicationLog.h"
 #include "inet/physicallayer/wireless/common/radio/packetlevel/Radio.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/ICommunicationCache.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IErrorModel.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IMediumLimitCache.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/INeighborCache.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
+#include "inet/mobility/contract/IMobility.h"
+#include "LoRaPhy/ILoRaPathLoss.h"
+#include "LoRaPhy/LoRaInterferenceIndex.h"
+#include "LoRaPhy/LoRaRadioTable.h"
+#include "LoRaPhy/LoRaSpatialGrid.h"
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
 
 namespace lpwan {
 class LoRaMedium : public RadioMedium
@@ -37,11 +45,91 @@ class LoRaMedium : public RadioMedium
     friend class LoRaRadio;
 
 protected:
+    /**
+     * When set, arrivals and listenings are only computed and cached when a
+     * receiver first asks for them, the interference interval is still added
+     * eagerly.
+     */
+    bool lazyArrivals = false;
+    /**
+     * Antenna positions of the radios bucketed by the maximum interference
+     * range, used to restrict the fan-out of a transmission to the radios
+     * that can hear it.
+     */
+    LoRaSpatialGrid spatialGrid;
+    std::unordered_map<const IMobility *, std::vector<const IRadio *>> mobilityToRadios;
+    /**
+     * Arrival intervals partitioned by channel, replaces the interval trees of
+     * the communication cache.
+     */
+    LoRaInterferenceIndex interferenceIndex;
+    /**
+     * Packed positions, limits and LoRa parameters of the radios.
+     */
+    LoRaRadioTable radioTable;
+    /**
+     * When set, the path loss towards every receiver of a transmission is
+     * computed in one batch when the transmission is added.
+     */
+    bool batchPathLoss = false;
+    const ILoRaPathLoss *loRaPathLoss = nullptr;
+    struct BatchedPathLoss
+    {
+        const IRadio *receiver;
+        Coord receiverPosition;
+        double pathLoss;
+        bool operator<(const BatchedPathLoss& other) const { return std::less<const IRadio *>()(receiver, other.receiver); }
+    };
+    struct BatchedPathLosses
+    {
+        simtime_t interferenceEndTime;
+        /**
+         * Sorted by receiver, the vectors of expired transmissions are
+         * recycled so that their capacity is reused.
+         */
+        std::vector<BatchedPathLoss> pathLosses;
+    };
+    std::unordered_map<const ITransmission *, BatchedPathLosses> transmissionToPathLosses;
+    std::vector<std::vector<BatchedPathLoss>> freePathLosses;
+    /** @name Scratch buffers of the batch path loss computation. */
+    //@{
+    std::vector<const IRadio *> batchReceivers;
+    std::vector<Coord> batchPositions;
+    std::vector<double> batchDistances;
+    std::vector<double> batchShadowings;
+    std::vector<double> batchPathLosses;
+    //@}
+    /**
+     * Error model used for the indications of receivers that do not add
+     * them, resolved once.
+     */
+    const IErrorModel *errorModel = nullptr;
+
+protected:
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *message) override;
     virtual bool matchesMacAddressFilter(const IRadio *radio, const Packet *packet) const override;
+    virtual void addArrival(const IRadio *receiverRadio, const ITransmission *transmission, simtime_t& maxArrivalEndTime);
+    virtual void computeBatchedPathLosses(const ITransmission *transmission);
+    virtual const IListening *createListening(const IRadio *receiverRadio, const ITransmission *transmission, const IArrival *arrival) const;
+    virtual std::vector<const IReception *> *computeInterferingReceptions(const IListening *listening) const override;
+    virtual std::vector<const IReception *> *computeInterferingReceptions(const IReception *reception) const override;
+    using RadioMedium::receiveSignal;
+    virtual void receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details) override;
         //@}
     public:
       LoRaMedium();
       virtual ~LoRaMedium();
+      virtual const LoRaRadioTable& getRadioTable() const { return radioTable; }
+      /**
+       * Returns true and sets pathLoss if it was computed in a batch when the
+       * transmission was added for the receiver at the given arrival position.
+       */
+      virtual bool getBatchedPathLoss(const IRadio *receiver, const ITransmission *transmission, const Coord& receiverPosition, double& pathLoss) const;
+      virtual void addRadio(const IRadio *radio) override;
+      virtual void removeRadio(const IRadio *radio) override;
+      virtual const IArrival *getArrival(const IRadio *receiver, const ITransmission *transmission) const override;
+      virtual const IListening *getListening(const IRadio *receiver, const ITransmission *transmission) const override;
       //virtual const IReceptionDecision *getReceptionDecision(const IRadio *receiver, const IListening *listening, const ITransmission *transmission, IRadioSignal::SignalPart part) const override;
       virtual const IReceptionResult *getReceptionResult(const IRadio *receiver, const IListening *listening, const ITransmission *transmission) const override;
       virtual void addTransmission(const IRadio *transmitter, const ITransmission *transmission);
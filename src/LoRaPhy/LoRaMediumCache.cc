@@ -48,6 +48,18 @@ template<typename T> inline T maxIgnoreNaN(T a, T b)
         return b;
 }
 
+inline double minIgnoreNaN(double a, double b)
+{
+    if (std::isnan(a))
+        return b;
+    else if (std::isnan(b))
+        return a;
+    else if (a < b)
+        return a;
+    else
+        return b;
+}
+
 inline double maxIgnoreNaN(double a, double b)
 {
     if (std::isnan(a))
@@ -127,66 +139,94 @@ void LoRaMediumCache::updateLimits()
     maxInterferenceRange = computeMaxInterferenceRange();
 }
 
+void LoRaMediumCache::insertLimitValue(LimitValues& values, double value)
+{
+    if (!std::isnan(value))
+        values.insert(value);
+}
+
+void LoRaMediumCache::eraseLimitValue(LimitValues& values, double value)
+{
+    if (!std::isnan(value)) {
+        auto it = values.find(value);
+        if (it != values.end())
+            values.erase(it);
+    }
+}
+
 void LoRaMediumCache::addRadio(const IRadio *radio)
 {
-    radios.push_back(radio);
+    if (radioLimits.find(radio) != radioLimits.end())
+        throw cRuntimeError("Radio %d is already in the medium limit cache", radio->getId());
+    const LoRaRadioTable& radioTable = radioMedium->getRadioTable();
+    size_t slot = radioTable.getSlot(radio);
+    const IMobility *mobility = radio->getAntenna()->getMobility();
+    RadioLimits& limits = radioLimits[radio];
+    limits.maxSpeed = radioTable.getMaxSpeeds()[slot];
+    limits.maxTransmissionPower = radioTable.getMaxTransmissionPowers()[slot];
+    limits.minInterferencePower = radioTable.getMinInterferencePowers()[slot];
+    limits.minReceptionPower = radioTable.getMinReceptionPowers()[slot];
+    limits.maxAntennaGain = radioTable.getMaxAntennaGains()[slot];
+    limits.minConstraintArea = mobility->getConstraintAreaMin();
+    limits.maxConstraintArea = mobility->getConstraintAreaMax();
+    insertLimitValue(maxSpeeds, limits.maxSpeed);
+    insertLimitValue(maxTransmissionPowers, limits.maxTransmissionPower);
+    insertLimitValue(minInterferencePowers, limits.minInterferencePower);
+    insertLimitValue(minReceptionPowers, limits.minReceptionPower);
+    insertLimitValue(maxAntennaGains, limits.maxAntennaGain);
+    insertLimitValue(minConstraintAreaXs, limits.minConstraintArea.x);
+    insertLimitValue(minConstraintAreaYs, limits.minConstraintArea.y);
+    insertLimitValue(minConstraintAreaZs, limits.minConstraintArea.z);
+    insertLimitValue(maxConstraintAreaXs, limits.maxConstraintArea.x);
+    insertLimitValue(maxConstraintAreaYs, limits.maxConstraintArea.y);
+    insertLimitValue(maxConstraintAreaZs, limits.maxConstraintArea.z);
     updateLimits();
 }
 
 void LoRaMediumCache::removeRadio(const IRadio *radio)
 {
-    radios.erase(std::remove(radios.begin(), radios.end(), radio), radios.end());
+    auto it = radioLimits.find(radio);
+    if (it == radioLimits.end())
+        return;
+    const RadioLimits& limits = it->second;
+    eraseLimitValue(maxSpeeds, limits.maxSpeed);
+    eraseLimitValue(maxTransmissionPowers, limits.maxTransmissionPower);
+    eraseLimitValue(minInterferencePowers, limits.minInterferencePower);
+    eraseLimitValue(minReceptionPowers, limits.minReceptionPower);
+    eraseLimitValue(maxAntennaGains, limits.maxAntennaGain);
+    eraseLimitValue(minConstraintAreaXs, limits.minConstraintArea.x);
+    eraseLimitValue(minConstraintAreaYs, limits.minConstraintArea.y);
+    eraseLimitValue(minConstraintAreaZs, limits.minConstraintArea.z);
+    eraseLimitValue(maxConstraintAreaXs, limits.maxConstraintArea.x);
+    eraseLimitValue(maxConstraintAreaYs, limits.maxConstraintArea.y);
+    eraseLimitValue(maxConstraintAreaZs, limits.maxConstraintArea.z);
+    radioLimits.erase(it);
     updateLimits();
 }
 
 mps LoRaMediumCache::computeMaxSpeed() const
 {
-    mps maxSpeed = mps(par("maxSpeed"));
-    for (const auto radio : radios) {
-        if (radio != nullptr)
-            maxSpeed = maxIgnoreNaN(maxSpeed, mps(radio->getAntenna()->getMobility()->getMaxSpeed()));
-    }
-    return maxSpeed;
+    return mps(maxIgnoreNaN(par("maxSpeed").doubleValue(), getMaxLimitValue(maxSpeeds)));
 }
 
 W LoRaMediumCache::computeMaxTransmissionPower() const
 {
-    W maxTransmissionPower = W(par("maxTransmissionPower"));
-    for (const auto radio : radios) {
-        if (radio != nullptr)
-            maxTransmissionPower = maxIgnoreNaN(maxTransmissionPower, radio->getTransmitter()->getMaxPower());
-    }
-    return maxTransmissionPower;
+    return W(maxIgnoreNaN(par("maxTransmissionPower").doubleValue(), getMaxLimitValue(maxTransmissionPowers)));
 }
 
 W LoRaMediumCache::computeMinInterferencePower() const
 {
-    W minInterferencePower = mW(math::dBmW2mW(par("minInterferencePower")));
-    for (const auto radio : radios) {
-        if (radio != nullptr)
-            minInterferencePower = minIgnoreNaN(minInterferencePower, radio->getReceiver()->getMinInterferencePower());
-    }
-    return minInterferencePower;
+    return W(minIgnoreNaN(math::dBmW2mW(par("minInterferencePower")) / 1000, getMinLimitValue(minInterferencePowers)));
 }
 
 W LoRaMediumCache::computeMinReceptionPower() const
 {
-    W minReceptionPower = mW(math::dBmW2mW(par("minReceptionPower")));
-    for (const auto radio : radios) {
-        if (radio != nullptr)
-            minReceptionPower = minIgnoreNaN(minReceptionPower, radio->getReceiver()->getMinReceptionPower());
-    }
-    return minReceptionPower;
+    return W(minIgnoreNaN(math::dBmW2mW(par("minReceptionPower")) / 1000, getMinLimitValue(minReceptionPowers)));
 }
 
 double LoRaMediumCache::computeMaxAntennaGain() const
 {
-    double maxAntennaGain = math::dB2fraction(par("maxAntennaGain"));
-    for (const auto radio : radios) {
-        if (radio != nullptr)
-            maxAntennaGain = maxIgnoreNaN(maxAntennaGain, radio->getAntenna()->getGain()->getMaxGain());
-    }
-    return maxAntennaGain;
+    return maxIgnoreNaN(math::dB2fraction(par("maxAntennaGain")), getMaxLimitValue(maxAntennaGains));
 }
 
 m LoRaMediumCache::computeMaxRange(W maxTransmissionPower, W minReceptionPower) const
@@ -214,26 +254,12 @@ const simtime_t LoRaMediumCache::computeMaxTransmissionDuration() const
 
 Coord LoRaMediumCache::computeMinConstraintArea() const
 {
-    Coord minConstraintArea = Coord::NIL;
-    for (const auto radio : radios) {
-        if (radio != nullptr) {
-            const IMobility *mobility = radio->getAntenna()->getMobility();
-            minConstraintArea = minConstraintArea.min(mobility->getConstraintAreaMin());
-        }
-    }
-    return minConstraintArea;
+    return Coord(getMinLimitValue(minConstraintAreaXs), getMinLimitValue(minConstraintAreaYs), getMinLimitValue(minConstraintAreaZs));
 }
 
 Coord LoRaMediumCache::computeMaxConstreaintArea() const
 {
-    Coord maxConstraintArea = Coord::NIL;
-    for (const auto radio : radios) {
-        if (radio != nullptr) {
-            const IMobility *mobility = radio->getAntenna()->getMobility();
-            maxConstraintArea = maxConstraintArea.max(mobility->getConstraintAreaMax());
-        }
-    }
-    return maxConstraintArea;
+    return Coord(getMaxLimitValue(maxConstraintAreaXs), getMaxLimitValue(maxConstraintAreaYs), getMaxLimitValue(maxConstraintAreaZs));
 }
 
 m LoRaMediumCache::getMaxInterferenceRange(const IRadio* radio) const
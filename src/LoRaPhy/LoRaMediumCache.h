@@ -21,6 +21,8 @@
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IRadioMedium.h"
 #include "inet/physicallayer/wireless/common/contract/packetlevel/IMediumLimitCache.h"
 #include "LoRaPhy/LoRaMedium.h"
+#include <map>
+#include <set>
 
 namespace lpwan {
 
@@ -33,9 +35,35 @@ class LoRaMediumCache : public cModule, public IMediumLimitCache
     const LoRaMedium *radioMedium;
 
     /**
-     * The list of communicating radios on the medium.
+     * The per-radio values of the limits, NaN values are left out.
      */
-    std::vector<const IRadio *> radios;
+    struct RadioLimits
+    {
+        double maxSpeed;
+        double maxTransmissionPower;
+        double minInterferencePower;
+        double minReceptionPower;
+        double maxAntennaGain;
+        Coord minConstraintArea;
+        Coord maxConstraintArea;
+    };
+    typedef std::multiset<double> LimitValues;
+
+    /**
+     * The limits contributed by the communicating radios on the medium, kept
+     * so that removing a radio takes out exactly what adding it put in.
+     */
+    std::map<const IRadio *, RadioLimits> radioLimits;
+    /** @name Ordered values of each limit over the radios. */
+    //@{
+    LimitValues maxSpeeds;
+    LimitValues maxTransmissionPowers;
+    LimitValues minInterferencePowers;
+    LimitValues minReceptionPowers;
+    LimitValues maxAntennaGains;
+    LimitValues minConstraintAreaXs, minConstraintAreaYs, minConstraintAreaZs;
+    LimitValues maxConstraintAreaXs, maxConstraintAreaYs, maxConstraintAreaZs;
+    //@}
 
     /** @name Various radio medium limits. */
     /**
@@ -101,6 +129,11 @@ class LoRaMediumCache : public cModule, public IMediumLimitCache
     virtual int numInitStages() const override { return NUM_INIT_STAGES; }
     virtual void initialize(int stage) override;
 
+    static void insertLimitValue(LimitValues& values, double value);
+    static void eraseLimitValue(LimitValues& values, double value);
+    static double getMinLimitValue(const LimitValues& values) { return values.empty() ? NaN : *values.begin(); }
+    static double getMaxLimitValue(const LimitValues& values) { return values.empty() ? NaN : *values.rbegin(); }
+
     /** @name Compute limits */
     //@{
     virtual Coord computeMinConstraintArea() const;
@@ -42,6 +42,10 @@ class LoRaModulation : public ApskModulationBase
 
     double calculateBER(double snir, Hz bandwidth, bps bitrate) const;
     double calculateSER(double snir, Hz bandwidth, bps bitrate) const;
+    /**
+     * Batch variant of calculateBER for count SNIR samples.
+     */
+    void calculateBERs(const double *snirs, double *bers, size_t count) const;
 };
 
 } // namespace inet
@@ -17,6 +17,7 @@
 
 #include "LoRaPhy/LoRaNeighborCache.h"
 #include "inet/common/ModuleAccess.h"
+#include <algorithm>
 
 namespace lpwan {
 
@@ -24,10 +25,10 @@ Define_Module(LoRaNeighborCache);
 
 LoRaNeighborCache::LoRaNeighborCache() :
     radioMedium(nullptr),
-    updateNeighborListsTimer(nullptr),
     refillPeriod(NaN),
     range(NaN),
-    maxSpeed(NaN)
+    maxSpeed(NaN),
+    radius(NaN)
 {
 }
 
@@ -37,13 +38,10 @@ void LoRaNeighborCache::initialize(int stage)
         radioMedium = getModuleFromPar<LoRaMedium>(par("radioMediumModule"), this);
         refillPeriod = par("refillPeriod");
         range = par("range");
-        updateNeighborListsTimer = new cMessage("updateNeighborListsTimer");
     }
     else if (stage == INITSTAGE_PHYSICAL_LAYER_NEIGHBOR_CACHE) {
-        maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
+        updateRadius();
         updateNeighborLists();
-        if (maxSpeed != 0)
-            scheduleAt(simTime() + refillPeriod, updateNeighborListsTimer);
     }
 }
 
@@ -76,30 +74,76 @@ void LoRaNeighborCache::sendToNeighbors(IRadio *transmitter, const IWirelessSign
 
 void LoRaNeighborCache::handleMessage(cMessage *msg)
 {
-    if (!msg->isSelfMessage())
-        throw cRuntimeError("This module only handles self messages");
+    throw cRuntimeError("This module doesn't handle messages");
+}
 
-    updateNeighborLists();
+void LoRaNeighborCache::receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details)
+{
+    Enter_Method_Silent();
+    if (signal == IMobility::mobilityStateChangedSignal) {
+        // before the initial build there are no neighbor lists to keep valid
+        if (std::isnan(radius))
+            return;
+        IMobility *mobility = check_and_cast<IMobility *>(value);
+        auto it = mobilityToRadios.find(mobility);
+        if (it == mobilityToRadios.end())
+            return;
+        Coord position = mobility->getCurrentPosition();
+        // the lists are built with maxSpeed * refillPeriod slack over the
+        // range, as long as each radio stays within half of it from its
+        // bucketed position every pair within range is still listed
+        double displacementBudget = (radius - range) / 2;
+        for (auto radio : it->second) {
+            if (grid.getPosition(radio).distance(position) > displacementBudget)
+                updateRadioPosition(radioToEntry[radio], position);
+        }
+    }
+    else
+        throw cRuntimeError("Unknown signal");
+}
 
-    scheduleAt(simTime() + refillPeriod, msg);
+bool LoRaNeighborCache::updateRadius()
+{
+    maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
+    double oldRadius = radius;
+    radius = maxSpeed * refillPeriod + range;
+    if (radius > 0 && !std::isinf(radius))
+        grid.setCellSize(radius);
+    return radius != oldRadius;
+}
+
+template<typename F>
+void LoRaNeighborCache::mapCandidates(const Coord& position, F f) const
+{
+    // the grid can't bucket an unbounded or empty radius
+    if (grid.getCellSize() == radius)
+        grid.mapRadios(position, radius, f);
+    else
+        for (auto & elem : radios)
+            f(elem->radio);
 }
 
 void LoRaNeighborCache::updateNeighborList(RadioEntry *radioEntry)
 {
-    IMobility *radioMobility = radioEntry->radio->getAntenna()->getMobility();
-    Coord radioPosition = radioMobility->getCurrentPosition();
-    double radius = maxSpeed * refillPeriod + range;
+    const IRadio *radio = radioEntry->radio;
+    const Coord& radioPosition = grid.getPosition(radio);
     radioEntry->neighborVector.clear();
 
-    for (auto & elem : radios) {
-        const IRadio *otherRadio = elem->radio;
-        Coord otherEntryPosition = otherRadio->getAntenna()->getMobility()->getCurrentPosition();
-
-        if (otherRadio->getId() != radioEntry->radio->getId() &&
-            otherEntryPosition.sqrdist(radioPosition) <= radius * radius)
+    mapCandidates(radioPosition, [&] (const IRadio *otherRadio) {
+        if (otherRadio != radio && grid.getPosition(otherRadio).sqrdist(radioPosition) <= radius * radius)
             radioEntry->neighborVector.push_back(otherRadio);
-    }
+    });
+}
 
+void LoRaNeighborCache::updateRadioPosition(RadioEntry *radioEntry, const Coord& position)
+{
+    const IRadio *radio = radioEntry->radio;
+    EV_DETAIL << "Updating the neighbor list of radio " << radio->getId() << endl;
+    removeRadioFromNeighborLists(radio);
+    grid.updateRadio(radio, position);
+    updateNeighborList(radioEntry);
+    for (auto neighbor : radioEntry->neighborVector)
+        radioToEntry[neighbor]->neighborVector.push_back(radio);
 }
 
 void LoRaNeighborCache::addRadio(const IRadio *radio)
@@ -107,21 +151,45 @@ void LoRaNeighborCache::addRadio(const IRadio *radio)
     RadioEntry *newEntry = new RadioEntry(radio);
     radios.push_back(newEntry);
     radioToEntry[radio] = newEntry;
-    updateNeighborLists();
-    maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
-    if (maxSpeed != 0 && !updateNeighborListsTimer->isScheduled() && initialized())
-        scheduleAt(simTime() + refillPeriod, updateNeighborListsTimer);
+    IMobility *mobility = radio->getAntenna()->getMobility();
+    grid.addRadio(radio, mobility->getCurrentPosition());
+    Radios& mobilityRadios = mobilityToRadios[mobility];
+    if (mobilityRadios.empty())
+        check_and_cast<cModule *>(mobility)->subscribe(IMobility::mobilityStateChangedSignal, this);
+    mobilityRadios.push_back(radio);
+    // before the initial build the neighbor lists are empty anyway
+    if (!std::isnan(radius)) {
+        if (updateRadius())
+            updateNeighborLists();
+        else {
+            updateNeighborList(newEntry);
+            for (auto neighbor : newEntry->neighborVector)
+                radioToEntry[neighbor]->neighborVector.push_back(radio);
+        }
+    }
 }
 
 void LoRaNeighborCache::removeRadio(const IRadio *radio)
 {
-    auto it = find(radios.begin(), radios.end(), radioToEntry[radio]);
+    auto jt = radioToEntry.find(radio);
+    auto it = jt != radioToEntry.end() ? find(radios.begin(), radios.end(), jt->second) : radios.end();
     if (it != radios.end()) {
         removeRadioFromNeighborLists(radio);
+        RadioEntry *radioEntry = jt->second;
         radios.erase(it);
-        maxSpeed = radioMedium->getMediumLimitCache()->getMaxSpeed().get();
-        if (maxSpeed == 0 && initialized())
-            cancelEvent(updateNeighborListsTimer);
+        radioToEntry.erase(jt);
+        grid.removeRadio(radio);
+        delete radioEntry;
+        IMobility *mobility = radio->getAntenna()->getMobility();
+        auto kt = mobilityToRadios.find(mobility);
+        if (kt != mobilityToRadios.end()) {
+            Radios& mobilityRadios = kt->second;
+            mobilityRadios.erase(std::remove(mobilityRadios.begin(), mobilityRadios.end(), radio), mobilityRadios.end());
+            if (mobilityRadios.empty()) {
+                check_and_cast<cModule *>(mobility)->unsubscribe(IMobility::mobilityStateChangedSignal, this);
+                mobilityToRadios.erase(kt);
+            }
+        }
     }
     else {
         throw cRuntimeError("You can't remove radio: %d because it is not in our radio vector", radio->getId());
@@ -131,14 +199,17 @@ void LoRaNeighborCache::removeRadio(const IRadio *radio)
 void LoRaNeighborCache::updateNeighborLists()
 {
     EV_DETAIL << "Updating the neighbor lists" << endl;
+    for (auto & elem : radios)
+        grid.updateRadio(elem->radio, elem->radio->getAntenna()->getMobility()->getCurrentPosition());
     for (auto & elem : radios)
         updateNeighborList(elem);
 }
 
 void LoRaNeighborCache::removeRadioFromNeighborLists(const IRadio *radio)
 {
-    for (auto & elem : radios) {
-        Radios neighborVector = elem->neighborVector;
+    // neighborship is symmetric, so only the neighbors of the radio refer to it
+    for (auto neighbor : radioToEntry[radio]->neighborVector) {
+        Radios& neighborVector = radioToEntry[neighbor]->neighborVector;
         auto it = find(neighborVector.begin(), neighborVector.end(), radio);
         if (it != neighborVector.end())
             neighborVector.erase(it);
@@ -149,8 +220,6 @@ LoRaNeighborCache::~LoRaNeighborCache()
 {
     for (auto & elem : radios)
         delete elem;
-
-    cancelAndDelete(updateNeighborListsTimer);
 }
 
 } // namespace inet
@@ -19,12 +19,13 @@
 
 #include "inet/physicallayer/wireless/common/medium/RadioMedium.h"
 #include "LoRaPhy/LoRaMedium.h"
+#include "LoRaPhy/LoRaSpatialGrid.h"
 #include <set>
 #include <vector>
 
 namespace lpwan {
 
-class LoRaNeighborCache : public cSimpleModule, public INeighborCache
+class LoRaNeighborCache : public cSimpleModule, public cListener, public INeighborCache
 {
   public:
     struct RadioEntry
@@ -44,17 +45,30 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
   protected:
     LoRaMedium *radioMedium;
     RadioEntries radios;
-    cMessage *updateNeighborListsTimer;
     RadioEntryCache radioToEntry;
     double refillPeriod;
     double range;
     double maxSpeed;
+    /**
+     * The neighbor radius, NaN until the neighbor lists are first built.
+     */
+    double radius;
+    /**
+     * Radio positions as of the last neighbor list update bucketed by the
+     * neighbor radius, so that a neighbor list is built from the adjacent
+     * cells only.
+     */
+    LoRaSpatialGrid grid;
+    std::map<const IMobility *, Radios> mobilityToRadios;
 
   protected:
     virtual int numInitStages() const override { return NUM_INIT_STAGES; }
     virtual void initialize(int stage) override;
     virtual void handleMessage(cMessage *msg) override;
+    bool updateRadius();
+    template<typename F> void mapCandidates(const Coord& position, F f) const;
     void updateNeighborList(RadioEntry *radioEntry);
+    void updateRadioPosition(RadioEntry *radioEntry, const Coord& position);
     void updateNeighborLists();
     void removeRadioFromNeighborLists(const IRadio *radio);
 
@@ -65,6 +79,7 @@ class LoRaNeighborCache : public cSimpleModule, public INeighborCache
     virtual std::ostream& printToStream(std::ostream& stream, int level, int evFlags = 0) const override;
     virtual void addRadio(const IRadio *radio) override;
     virtual void removeRadio(const IRadio *radio) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signal, cObject *value, cObject *details) override;
     virtual void sendToNeighbors(IRadio *transmitter, const IWirelessSignal *frame, double range) const override;
 };
 
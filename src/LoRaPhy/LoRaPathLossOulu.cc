@@ -37,11 +37,20 @@ void LoRaPathLossOulu::initialize(int stage)
 
 double LoRaPathLossOulu::computePathLoss(mps propagationSpeed, Hz frequency, m distance) const
 {
-    //EPL = B + 10nlog10( d / d0 )
-    //double PL_d0_db = 127.41;
-    //double PL_db = PL_d0_db + 10 * gamma * log10(unit(distance / d0).get()) + normal(0.0, sigma);
-    double PL_db = B + 10 * n * log10(unit(distance/d0).get()) - antennaGain + normal(0.0, sigma);
-    return math::dB2fraction(-PL_db);
+    return computePathLoss(distance.get(), normal(0.0, sigma));
+}
+
+void LoRaPathLossOulu::computePathLosses(const double *distances, const double *shadowings, double *pathLosses, size_t count) const
+{
+    // same passes as LoRaLogNormalShadowing::computePathLosses
+    double slope = 10 * n;
+    double distance0 = d0.get();
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = log10(distances[i] / distance0);
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = -(B + slope * pathLosses[i] - antennaGain + shadowings[i]) / 10;
+    for (size_t i = 0; i < count; i++)
+        pathLosses[i] = pow(10.0, pathLosses[i]);
 }
 
 }
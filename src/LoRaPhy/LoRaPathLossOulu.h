@@ -17,6 +17,8 @@
 #define LORAPHY_LORAPATHLOSSOULU_H_
 
 #include "inet/physicallayer/wireless/common/pathloss/FreeSpacePathLoss.h"
+#include "inet/common/INETMath.h"
+#include "LoRaPhy/ILoRaPathLoss.h"
 
 using namespace inet;
 using namespace inet::physicallayer;
@@ -25,7 +27,7 @@ namespace lpwan {
 /**
  * This class implements the log normal shadowing model.
  */
-class LoRaPathLossOulu : public FreeSpacePathLoss
+class LoRaPathLossOulu : public FreeSpacePathLoss, public ILoRaPathLoss
 {
   protected:
     m d0;
@@ -37,9 +39,18 @@ class LoRaPathLossOulu : public FreeSpacePathLoss
   protected:
     virtual void initialize(int stage) override;
 
+    double computePathLoss(double distance, double shadowing) const
+    {
+        //EPL = B + 10nlog10( d / d0 )
+        double PL_db = B + 10 * n * log10(distance / d0.get()) - antennaGain + shadowing;
+        return math::dB2fraction(-PL_db);
+    }
+
   public:
     LoRaPathLossOulu();
     virtual double computePathLoss(mps propagationSpeed, Hz frequency, m distance) const override;
+    virtual double computeShadowing(const ITransmission *transmission, const IRadio *receiver, const Coord& receiverPosition) const override { return normal(0.0, sigma); }
+    virtual void computePathLosses(const double *distances, const double *shadowings, double *pathLosses, size_t count) const override;
 };
 
 } // namespace inet
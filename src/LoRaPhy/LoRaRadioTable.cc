@@ -0,0 +1,60 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaRadioTable.h"
+#include "inet/mobility/contract/IMobility.h"
+
+namespace lpwan {
+
+void LoRaRadioTable::addRadio(const IRadio *radio)
+{
+    if (radioToSlot.find(radio) != radioToSlot.end())
+        throw cRuntimeError("Radio %d is already in the radio table", radio->getId());
+    radioToSlot[radio] = radios.size();
+    radios.push_back(radio);
+    IMobility *mobility = radio->getAntenna()->getMobility();
+    maxSpeeds.push_back(mobility->getMaxSpeed());
+    auto transmitter = radio->getTransmitter();
+    auto receiver = radio->getReceiver();
+    maxTransmissionPowers.push_back(transmitter != nullptr ? transmitter->getMaxPower().get() : NaN);
+    minInterferencePowers.push_back(receiver != nullptr ? receiver->getMinInterferencePower().get() : NaN);
+    minReceptionPowers.push_back(receiver != nullptr ? receiver->getMinReceptionPower().get() : NaN);
+    maxAntennaGains.push_back(radio->getAntenna()->getGain()->getMaxGain());
+}
+
+template<typename T> static void swapPop(std::vector<T>& column, size_t slot)
+{
+    column[slot] = column.back();
+    column.pop_back();
+}
+
+void LoRaRadioTable::removeRadio(const IRadio *radio)
+{
+    auto it = radioToSlot.find(radio);
+    if (it == radioToSlot.end())
+        return;
+    size_t slot = it->second;
+    radioToSlot.erase(it);
+    if (slot != radios.size() - 1)
+        radioToSlot[radios.back()] = slot;
+    swapPop(radios, slot);
+    swapPop(maxSpeeds, slot);
+    swapPop(maxTransmissionPowers, slot);
+    swapPop(minInterferencePowers, slot);
+    swapPop(minReceptionPowers, slot);
+    swapPop(maxAntennaGains, slot);
+}
+
+} // namespace lpwan
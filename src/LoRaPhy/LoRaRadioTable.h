@@ -0,0 +1,71 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORARADIOTABLE_H_
+#define LORAPHY_LORARADIOTABLE_H_
+
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
+#include <unordered_map>
+#include <vector>
+
+using namespace inet;
+using namespace inet::physicallayer;
+
+namespace lpwan {
+
+/**
+ * Struct-of-arrays table of the radios on the medium. The limits of each
+ * radio are snapshotted into contiguous columns indexed by slot when the
+ * radio is added, so that the medium cache reads packed doubles instead of
+ * going through the radio, antenna and mobility interfaces. Positions are not
+ * kept here, the spatial grid tracks them. Removal swaps the last slot into
+ * the removed one, so slots are not stable across removals.
+ */
+class LoRaRadioTable
+{
+  protected:
+    std::unordered_map<const IRadio *, size_t> radioToSlot;
+
+    std::vector<const IRadio *> radios;
+    std::vector<double> maxSpeeds; // m/s
+    std::vector<double> maxTransmissionPowers; // W
+    std::vector<double> minInterferencePowers; // W
+    std::vector<double> minReceptionPowers; // W
+    std::vector<double> maxAntennaGains;
+
+  public:
+    size_t size() const { return radios.size(); }
+    size_t getSlot(const IRadio *radio) const { return radioToSlot.at(radio); }
+
+    void addRadio(const IRadio *radio);
+    void removeRadio(const IRadio *radio);
+
+    const IRadio *getRadio(size_t slot) const { return radios[slot]; }
+    const std::vector<double>& getMaxSpeeds() const { return maxSpeeds; }
+    const std::vector<double>& getMaxTransmissionPowers() const { return maxTransmissionPowers; }
+    const std::vector<double>& getMinInterferencePowers() const { return minInterferencePowers; }
+    const std::vector<double>& getMinReceptionPowers() const { return minReceptionPowers; }
+    const std::vector<double>& getMaxAntennaGains() const { return maxAntennaGains; }
+
+    template<typename F> void mapRadios(F f) const
+    {
+        for (auto radio : radios)
+            f(radio);
+    }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORARADIOTABLE_H_ */
@@ -14,7 +14,12 @@
 // 
 
 #include "LoRaReceiver.h"
+#include "LoRaRelayReceiver.h"
+#include "LoRa/LoRaGWRadio.h"
 #include "LoRaReception.h"
+#include "LoRaChannelPlanListening.h"
+#include "LoRaAnalogModel.h"
+#include "LoRaSensitivityTable.h"
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarNoise.h"
 #include "../LoRaApp/SimpleLoRaApp.h"
 #include "LoRaPhyPreamble_m.h"
@@ -23,71 +28,102 @@
 namespace lpwan {
 
 Define_Module(LoRaReceiver);
+Define_Module(LoRaGWReceiver);
 
-LoRaReceiver::LoRaReceiver() :
+void LoRaGatewayRole::getRadioSettings(const Radio *radio, Hz& cf, Hz& bw, int& sf)
+{
+    cf = radio->loRaCF;
+    bw = radio->loRaBW;
+    sf = radio->loRaSF;
+}
+
+template<typename RolePolicy>
+LoRaReceiverT<RolePolicy>::LoRaReceiverT() :
     snirThreshold(NaN)
 {
 }
 
-void LoRaReceiver::initialize(int stage)
+template<typename RolePolicy>
+void LoRaReceiverT<RolePolicy>::initialize(int stage)
 {
     FlatReceiverBase::initialize(stage);
     if (stage == INITSTAGE_LOCAL)
     {
         snirThreshold = math::dB2fraction(par("snirThreshold"));
         energyDetection = mW(math::dBmW2mW(par("energyDetection")));
-        if(strcmp(getParentModule()->getClassName(), "lpwan::LoRaGWRadio") == 0)
-        {
-            iAmGateway = true;
-        } else iAmGateway = false;
+        loRaRadio = dynamic_cast<Radio *>(getParentModule());
+        // the role is chosen by the receiver type, it can't follow the radio
+        if (loRaRadio == nullptr)
+            throw cRuntimeError("Receiver type %s doesn't match radio type %s, use LoRaReceiver with LoRaRadio, LoRaGWReceiver with LoRaGWRadio and LoRaRelayReceiver with LoRaRelayRadio",
+                    getNedTypeName(), getParentModule()->getNedTypeName());
+        macLayer = check_and_cast<Mac *>(getParentModule()->getParentModule()->getSubmodule("mac"));
         alohaChannelModel = par("alohaChannelModel");
-        LoRaReceptionCollision = registerSignal("LoRaReceptionCollision");
+        const char *collisionModel = par("collisionModel");
+        if (!strcmp(collisionModel, "pairwise"))
+            cumulativeCollisionModel = false;
+        else if (!strcmp(collisionModel, "cumulative"))
+            cumulativeCollisionModel = true;
+        else
+            throw cRuntimeError("Unknown collision model: '%s'", collisionModel);
+        errorModelDecision = par("errorModelDecision");
+        if (errorModelDecision && errorModel == nullptr)
+            throw cRuntimeError("The errorModelDecision parameter requires an error model, e.g. errorModel.typename = \"LoRaErrorModel\"");
+        channelPlan.parse(par("channelPlan"));
+        LoRaReceptionCollision = registerSignal(RolePolicy::getCollisionSignalName());
         numCollisions = 0;
         rcvBelowSensitivity = 0;
     }
 }
 
-void LoRaReceiver::finish()
+template<typename RolePolicy>
+void LoRaReceiverT<RolePolicy>::finish()
 {
-        recordScalar("numCollisions", numCollisions);
-        recordScalar("rcvBelowSensitivity", rcvBelowSensitivity);
-
+    FlatReceiverBase::finish();
+    recordScalar("numCollisions", numCollisions);
+    recordScalar("rcvBelowSensitivity", rcvBelowSensitivity);
 }
 
-bool LoRaReceiver::computeIsReceptionPossible(const IListening *listening, const ITransmission *transmission) const
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::computeIsReceptionPossible(const IListening *listening, const ITransmission *transmission) const
 {
     //here we can check compatibility of LoRaTx parameters (or beeing a gateway)
     const LoRaTransmission *loRaTransmission = check_and_cast<const LoRaTransmission *>(transmission);
-//    auto *loRaApp = check_and_cast<SimpleLoRaApp *>(getParentModule()->getParentModule()->getSubmodule("SimpleLoRaApp"));
-    auto *loRaRadio = check_and_cast<LoRaRadio *>(getParentModule());
-//    auto node = getContainingNode(this);
-//    auto loRaRadio = check_and_cast<LoRaRadio *>(node->getSubmodule("LoRaNic")->getSubmodule("LoRaRadio"));
-    if(iAmGateway || (loRaTransmission->getLoRaCF() == loRaRadio->loRaCF && loRaTransmission->getLoRaBW() == loRaRadio->loRaBW && loRaTransmission->getLoRaSF() == loRaRadio->loRaSF))
+    if (!channelPlan.isEmpty())
+        return channelPlan.contains(loRaTransmission->getLoRaCF(), loRaTransmission->getLoRaBW());
+    if (RolePolicy::acceptsAnySettings)
         return true;
-    else
-        return false;
+    Hz cf, bw;
+    int sf;
+    RolePolicy::getRadioSettings(loRaRadio, cf, bw, sf);
+    return loRaTransmission->getLoRaCF() == cf && loRaTransmission->getLoRaBW() == bw && loRaTransmission->getLoRaSF() == sf;
 }
 
-bool LoRaReceiver::computeIsReceptionPossible(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part) const
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::computeIsReceptionPossible(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part) const
 {
     //here we can check compatibility of LoRaTx parameters (or beeing a gateway) and reception above sensitivity level
     const LoRaBandListening *loRaListening = check_and_cast<const LoRaBandListening *>(listening);
     const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(reception);
-    if (iAmGateway == false && (loRaListening->getLoRaCF() != loRaReception->getLoRaCF() || loRaListening->getLoRaBW() != loRaReception->getLoRaBW() || loRaListening->getLoRaSF() != loRaReception->getLoRaSF())) {
+    if (!channelPlan.isEmpty()) {
+        // channels outside the plan are rejected before computing the power
+        if (!channelPlan.contains(loRaReception->getLoRaCF(), loRaReception->getLoRaBW()))
+            return false;
+    }
+    else if (!RolePolicy::acceptsAnySettings && (loRaListening->getLoRaCF() != loRaReception->getLoRaCF() || loRaListening->getLoRaBW() != loRaReception->getLoRaBW() || loRaListening->getLoRaSF() != loRaReception->getLoRaSF())) {
         return false;
-    } else {
-        W minReceptionPower = loRaReception->computeMinPower(reception->getStartTime(part), reception->getEndTime(part));
-        W sensitivity = getSensitivity(loRaReception);
-        bool isReceptionPossible = minReceptionPower >= sensitivity;
-        EV_DEBUG << "Computing whether reception is possible: minimum reception power = " << minReceptionPower << ", sensitivity = " << sensitivity << " -> reception is " << (isReceptionPossible ? "possible" : "impossible") << endl;
-        if(isReceptionPossible == false) {
-           const_cast<LoRaReceiver* >(this)->rcvBelowSensitivity++;
-        }
-        return isReceptionPossible;
     }
+    W minReceptionPower = loRaReception->computeMinPower(reception->getStartTime(part), reception->getEndTime(part));
+    W sensitivity = getSensitivity(loRaReception);
+    bool isReceptionPossible = minReceptionPower >= sensitivity;
+    EV_DEBUG << "Computing whether reception is possible: minimum reception power = " << minReceptionPower << ", sensitivity = " << sensitivity << " -> reception is " << (isReceptionPossible ? "possible" : "impossible") << endl;
+    if(isReceptionPossible == false) {
+       const_cast<LoRaReceiverT* >(this)->rcvBelowSensitivity++;
+    }
+    return isReceptionPossible;
 }
 
-bool LoRaReceiver::computeIsReceptionAttempted(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::computeIsReceptionAttempted(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
 {
     if(isPacketCollided(reception, part, interference))
     {
@@ -101,18 +137,11 @@ bool LoRaReceiver::computeIsReceptionAttempted(const IListening *listening, cons
         else if (loraMac)
             rec = loraMac->getReceiverAddress();
 
-        if (iAmGateway == false) {
-            auto *macLayer = check_and_cast<LoRaMac *>(getParentModule()->getParentModule()->getSubmodule("mac"));
-            if (rec == macLayer->getAddress()) {
-                const_cast<LoRaReceiver* >(this)->numCollisions++;
-            }
-            //EV << "Node: Extracted macFrame = " << loraMacFrame->getReceiverAddress() << ", node address = " << macLayer->getAddress() << std::endl;
-        } else {
-            auto *gwMacLayer = check_and_cast<LoRaGWMac *>(getParentModule()->getParentModule()->getSubmodule("mac"));
-            EV << "GW: Extracted macFrame = " << rec << ", node address = " << gwMacLayer->getAddress() << std::endl;
-            if (rec == MacAddress::BROADCAST_ADDRESS) {
-                const_cast<LoRaReceiver* >(this)->numCollisions++;
-            }
+        EV_DEBUG << "Extracted macFrame = " << rec << ", node address = " << RolePolicy::getAddress(macLayer) << endl;
+        if (RolePolicy::isCollisionCounted(macLayer, rec)) {
+            const_cast<LoRaReceiverT* >(this)->numCollisions++;
+            if (RolePolicy::emitsCountedCollisions)
+                const_cast<LoRaReceiverT* >(this)->emit(LoRaReceptionCollision, true);
         }
         return false;
     } else {
@@ -120,93 +149,134 @@ bool LoRaReceiver::computeIsReceptionAttempted(const IListening *listening, cons
     }
 }
 
-bool LoRaReceiver::isPacketCollided(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
+template<typename RolePolicy>
+int LoRaReceiverT<RolePolicy>::getCaptureThreshold(int receptionSF, int interferenceSF) const
+{
+    if (receptionSF < 7 || receptionSF > 12 || interferenceSF < 7 || interferenceSF > 12)
+        throw cRuntimeError("No capture threshold for SF%d interfered by SF%d, only SF7 to SF12 are supported", receptionSF, interferenceSF);
+    return nonOrthDelta[receptionSF - 7][interferenceSF - 7];
+}
+
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::isPacketCollidedCumulative(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
+{
+    auto interferingReceptions = interference->getInterferingReceptions();
+    const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(reception);
+    int receptionSF = loRaReception->getLoRaSF();
+    Hz receptionCF = loRaReception->getLoRaCF();
+    /* Only the last 6 symbols of the preamble and the payload are sensitive to interference */
+    double nPreamble = 8; //from the paper "Do Lora networks..."
+    simtime_t Tsym = (pow(2, receptionSF))/(loRaReception->getLoRaBW().get()/1000)/1000;
+    simtime_t csBegin = loRaReception->getPreambleStartTime() + Tsym * (nPreamble - 6);
+    simtime_t csEnd = loRaReception->getEndTime();
+    if (!(csBegin < csEnd))
+        return false;
+    double signalPower = loRaReception->getPower().get();
+    EV_DEBUG << "Received packet at SF: " << receptionSF << " with power " << math::mW2dBmW(signalPower*1000) << " dBm" << endl;
+
+    // every interferer contributes a start and an end edge clipped to the
+    // critical section, sorting them gives O(k log k) per reception
+    captureEdges.clear();
+    for (auto interferingReception : *interferingReceptions) {
+        const LoRaReception *loRaInterference = check_and_cast<const LoRaReception *>(interferingReception);
+        if (loRaInterference->getLoRaCF() != receptionCF)
+            continue;
+        simtime_t overlapBegin = std::max(loRaInterference->getStartTime(), csBegin);
+        simtime_t overlapEnd = std::min(loRaInterference->getEndTime(), csEnd);
+        if (!(overlapBegin < overlapEnd))
+            continue;
+        int interferenceSF = loRaInterference->getLoRaSF();
+        getCaptureThreshold(receptionSF, interferenceSF);
+        double power = loRaInterference->getPower().get();
+        captureEdges.push_back({overlapBegin, interferenceSF - 7, power});
+        captureEdges.push_back({overlapEnd, interferenceSF - 7, -power});
+    }
+    if (captureEdges.empty())
+        return false;
+    std::sort(captureEdges.begin(), captureEdges.end(), [] (const CaptureEdge& a, const CaptureEdge& b) { return a.time < b.time; });
+
+    /* The packet survives as long as the interference power of every SF, weighted by the capture threshold of that SF, sums up to at most the signal power */
+    double thresholds[6];
+    for (int i = 0; i < 6; i++)
+        thresholds[i] = math::dB2fraction(getCaptureThreshold(receptionSF, i + 7));
+    double interferencePowers[6] = {0, 0, 0, 0, 0, 0};
+    int numInterferers[6] = {0, 0, 0, 0, 0, 0};
+    for (size_t i = 0; i < captureEdges.size(); ) {
+        simtime_t time = captureEdges[i].time;
+        for (; i < captureEdges.size() && captureEdges[i].time == time; i++) {
+            const CaptureEdge& edge = captureEdges[i];
+            interferencePowers[edge.sfIndex] += edge.power;
+            numInterferers[edge.sfIndex] += edge.power > 0 ? 1 : -1;
+            // no rounding residue once an SF is quiet again
+            if (numInterferers[edge.sfIndex] == 0)
+                interferencePowers[edge.sfIndex] = 0;
+        }
+        double weightedInterferencePower = 0;
+        for (int j = 0; j < 6; j++)
+            weightedInterferencePower += interferencePowers[j] * thresholds[j];
+        if (weightedInterferencePower <= signalPower)
+            continue;
+        EV_DEBUG << "Cumulative interference at " << time << " exceeds the capture thresholds by "
+                 << math::fraction2dB(weightedInterferencePower / signalPower) << " dB -> packet is discarded" << endl;
+        if(RolePolicy::emitsCollisionSignal && (part == IRadioSignal::SIGNAL_PART_DATA || part == IRadioSignal::SIGNAL_PART_WHOLE)) const_cast<LoRaReceiverT* >(this)->emit(LoRaReceptionCollision, true);
+        return true;
+    }
+    return false;
+}
+
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::isPacketCollided(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const
 {
-    //auto radio = reception->getReceiver();
-    //auto radioMedium = radio->getMedium();
+    if (cumulativeCollisionModel && !alohaChannelModel)
+        return isPacketCollidedCumulative(reception, part, interference);
     auto interferingReceptions = interference->getInterferingReceptions();
     const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(reception);
+    // everything about the reception is computed once for all interferers
     simtime_t m_x = (loRaReception->getStartTime() + loRaReception->getEndTime())/2;
     simtime_t d_x = (loRaReception->getEndTime() - loRaReception->getStartTime())/2;
-    EV << "Czas transmisji to " << loRaReception->getEndTime() - loRaReception->getStartTime() << endl;
-    double P_threshold = 6;
-    W signalRSSI_w = loRaReception->getPower();
-    double signalRSSI_mw = signalRSSI_w.get()*1000;
-    double signalRSSI_dBm = math::mW2dBmW(signalRSSI_mw);
-    EV << signalRSSI_mw << endl;
-    EV << signalRSSI_dBm << endl;
+    double signalRSSI_dBm = math::mW2dBmW(loRaReception->getPower().get()*1000);
     int receptionSF = loRaReception->getLoRaSF();
+    Hz receptionCF = loRaReception->getLoRaCF();
+    /* If last 6 symbols of preamble are received, no collision*/
+    double nPreamble = 8; //from the paper "Do Lora networks..."
+    simtime_t Tsym = (pow(2, receptionSF))/(loRaReception->getLoRaBW().get()/1000)/1000;
+    simtime_t csBegin = loRaReception->getPreambleStartTime() + Tsym * (nPreamble - 6);
+    EV_DEBUG << "Received packet at SF: " << receptionSF << " with power " << signalRSSI_dBm << " dBm" << endl;
+
+    // the cheap checks come first, the interference power is only converted
+    // for interferers that can still be fatal, and the first fatal one ends
+    // the evaluation
     for (auto interferingReception : *interferingReceptions) {
-        bool overlap = false;
-        bool frequencyCollision = false;
-        bool captureEffect = false;
-        bool timingCollision = false; //Collision is acceptable in first part of preamble
         const LoRaReception *loRaInterference = check_and_cast<const LoRaReception *>(interferingReception);
-
+        if (loRaInterference->getLoRaCF() != receptionCF)
+            continue;
         simtime_t m_y = (loRaInterference->getStartTime() + loRaInterference->getEndTime())/2;
         simtime_t d_y = (loRaInterference->getEndTime() - loRaInterference->getStartTime())/2;
-        if(omnetpp::fabs(m_x - m_y) < d_x + d_y)
-        {
-            overlap = true;
-        }
-
-        if(loRaReception->getLoRaCF() == loRaInterference->getLoRaCF())
-        {
-            frequencyCollision = true;
-        }
-
-        W interferenceRSSI_w = loRaInterference->getPower();
-        double interferenceRSSI_mw = interferenceRSSI_w.get()*1000;
-        double interferenceRSSI_dBm = math::mW2dBmW(interferenceRSSI_mw);
-        int interferenceSF = loRaInterference->getLoRaSF();
-
-        /* If difference in power between two signals is greater than threshold, no collision*/
-        if(signalRSSI_dBm - interferenceRSSI_dBm >= nonOrthDelta[receptionSF-7][interferenceSF-7])
-        {
-            captureEffect = true;
-        }
-
-        EV << "[MSDEBUG] Received packet at SF: " << receptionSF << " with power " << signalRSSI_dBm << endl;
-        EV << "[MSDEBUG] Received interference at SF: " << interferenceSF << " with power " << interferenceRSSI_dBm << endl;
-        EV << "[MSDEBUG] Acceptable diff is equal " << nonOrthDelta[receptionSF-7][interferenceSF-7] << endl;
-        EV << "[MSDEBUG] Diff is equal " << signalRSSI_dBm - interferenceRSSI_dBm << endl;
-        if (captureEffect == false)
-        {
-            EV << "[MSDEBUG] Packet is discarded" << endl;
-        } else
-            EV << "[MSDEBUG] Packet is not discarded" << endl;
-
-        /* If last 6 symbols of preamble are received, no collision*/
-        double nPreamble = 8; //from the paper "Do Lora networks..."
-        simtime_t Tsym = (pow(2, loRaReception->getLoRaSF()))/(loRaReception->getLoRaBW().get()/1000)/1000;
-        simtime_t csBegin = loRaReception->getPreambleStartTime() + Tsym * (nPreamble - 6);
-        if(csBegin < loRaInterference->getEndTime())
-        {
-            timingCollision = true;
-        }
-
-        if (overlap && frequencyCollision)
-        {
-            if(alohaChannelModel == true)
-            {
-                if(iAmGateway && (part == IRadioSignal::SIGNAL_PART_DATA || part == IRadioSignal::SIGNAL_PART_WHOLE)) const_cast<LoRaReceiver* >(this)->emit(LoRaReceptionCollision, true);
-                return true;
-            }
-            if(alohaChannelModel == false)
-            {
-                if(captureEffect == false && timingCollision)
-                {
-                    if(iAmGateway && (part == IRadioSignal::SIGNAL_PART_DATA || part == IRadioSignal::SIGNAL_PART_WHOLE)) const_cast<LoRaReceiver* >(this)->emit(LoRaReceptionCollision, true);
-                    return true;
-                }
-            }
-
+        if (!(omnetpp::fabs(m_x - m_y) < d_x + d_y))
+            continue;
+        if (!alohaChannelModel) {
+            //Collision is acceptable in first part of preamble
+            if (!(csBegin < loRaInterference->getEndTime()))
+                continue;
+            double interferenceRSSI_dBm = math::mW2dBmW(loRaInterference->getPower().get()*1000);
+            int interferenceSF = loRaInterference->getLoRaSF();
+            /* If difference in power between two signals is greater than threshold, no collision*/
+            int captureThreshold = getCaptureThreshold(receptionSF, interferenceSF);
+            bool captureEffect = signalRSSI_dBm - interferenceRSSI_dBm >= captureThreshold;
+            EV_DEBUG << "Received interference at SF: " << interferenceSF << " with power " << interferenceRSSI_dBm << " dBm"
+                     << ", diff is " << signalRSSI_dBm - interferenceRSSI_dBm << ", acceptable diff is " << captureThreshold
+                     << " -> packet is " << (captureEffect ? "not discarded" : "discarded") << endl;
+            if (captureEffect)
+                continue;
         }
+        if(RolePolicy::emitsCollisionSignal && (part == IRadioSignal::SIGNAL_PART_DATA || part == IRadioSignal::SIGNAL_PART_WHOLE)) const_cast<LoRaReceiverT* >(this)->emit(LoRaReceptionCollision, true);
+        return true;
     }
     return false;
 }
 
-const IReceptionDecision *LoRaReceiver::computeReceptionDecision(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
+template<typename RolePolicy>
+const IReceptionDecision *LoRaReceiverT<RolePolicy>::computeReceptionDecision(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
 {
     auto isReceptionPossible = computeIsReceptionPossible(listening, reception, part);
     auto isReceptionAttempted = isReceptionPossible && computeIsReceptionAttempted(listening, reception, part, interference);
@@ -214,127 +284,111 @@ const IReceptionDecision *LoRaReceiver::computeReceptionDecision(const IListenin
     return new ReceptionDecision(reception, part, isReceptionPossible, isReceptionAttempted, isReceptionSuccessful);
 }
 
-Packet *LoRaReceiver::computeReceivedPacket(const ISnir *snir, bool isReceptionSuccessful) const
+template<typename RolePolicy>
+Packet *LoRaReceiverT<RolePolicy>::computeReceivedPacket(const ISnir *snir, bool isReceptionSuccessful) const
 {
     auto transmittedPacket = snir->getReception()->getTransmission()->getPacket();
-    auto receivedPacket = transmittedPacket->dup();
-    receivedPacket->clearTags();
+    // the chunks are immutable and shared with the transmitted packet, only
+    // the per receiver tags added later are allocated for this copy
+    auto receivedPacket = new Packet(transmittedPacket->getName(), transmittedPacket->peekAll());
+    receivedPacket->setKind(transmittedPacket->getKind());
+    receivedPacket->setTimestamp(transmittedPacket->getTimestamp());
 //    receivedPacket->addTag<PacketProtocolTag>()->setProtocol(transmittedPacket->getTag<PacketProtocolTag>()->getProtocol());
     if (!isReceptionSuccessful)
         receivedPacket->setBitError(true);
     return receivedPacket;
 }
 
-const IReceptionResult *LoRaReceiver::computeReceptionResult(const IListening *listening, const IReception *reception, const IInterference *interference, const ISnir *snir, const std::vector<const IReceptionDecision *> *decisions) const
+template<typename RolePolicy>
+const IReceptionResult *LoRaReceiverT<RolePolicy>::computeReceptionResult(const IListening *listening, const IReception *reception, const IInterference *interference, const ISnir *snir, const std::vector<const IReceptionDecision *> *decisions) const
 {
     bool isReceptionSuccessful = true;
     for (auto decision : *decisions)
         isReceptionSuccessful &= decision->isReceptionSuccessful();
     auto packet = computeReceivedPacket(snir, isReceptionSuccessful);
 
-    auto signalPowerInd = packet->addTagIfAbsent<SignalPowerInd>();
+    auto signalPowerInd = packet->addTag<SignalPowerInd>();
     const LoRaReception *loRaReception = check_and_cast<const LoRaReception *>(reception);
     W signalRSSI_w = loRaReception->getPower();
     signalPowerInd->setPower(signalRSSI_w);
 
-    auto snirInd = packet->addTagIfAbsent<SnirInd>();
+    auto snirInd = packet->addTag<SnirInd>();
     snirInd->setMinimumSnir(snir->getMin());
     snirInd->setMaximumSnir(snir->getMax());
-    auto signalTimeInd = packet->addTagIfAbsent<SignalTimeInd>();
+    auto signalTimeInd = packet->addTag<SignalTimeInd>();
     signalTimeInd->setStartTime(reception->getStartTime());
     signalTimeInd->setEndTime(reception->getEndTime());
-    auto errorRateInd = packet->addTagIfAbsent<ErrorRateInd>();
-    errorRateInd->setPacketErrorRate(errorModel ? errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-    errorRateInd->setBitErrorRate(errorModel ? errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
-    errorRateInd->setSymbolErrorRate(errorModel ? errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE) : 0.0);
+    // the reception decision only uses the error rates with errorModelDecision,
+    // otherwise they are computed for the statistics when an error model is
+    // configured
+    auto errorRateInd = packet->addTag<ErrorRateInd>();
+    if (errorModel) {
+        errorRateInd->setPacketErrorRate(errorModel->computePacketErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+        errorRateInd->setBitErrorRate(errorModel->computeBitErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+        errorRateInd->setSymbolErrorRate(errorModel->computeSymbolErrorRate(snir, IRadioSignal::SIGNAL_PART_WHOLE));
+    }
+    else {
+        errorRateInd->setPacketErrorRate(0.0);
+        errorRateInd->setBitErrorRate(0.0);
+        errorRateInd->setSymbolErrorRate(0.0);
+    }
 
     return new ReceptionResult(reception, decisions, packet);
 }
 
-bool LoRaReceiver::computeIsReceptionSuccessful(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
+template<typename RolePolicy>
+bool LoRaReceiverT<RolePolicy>::computeIsReceptionSuccessful(const IListening *listening, const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference, const ISnir *snir) const
 {
-    return true;
-    //we don't check the SINR level, it is done in collision checking by P_threshold level evaluation
+    //the SINR level is checked in collision checking by P_threshold level evaluation, the error model only adds bit errors on top
+    if (!errorModelDecision)
+        return true;
+    double packetErrorRate = errorModel->computePacketErrorRate(snir, part);
+    return packetErrorRate == 0 || uniform(0, 1) >= packetErrorRate;
 }
 
-const IListening *LoRaReceiver::createListening(const IRadio *radio, const simtime_t startTime, const simtime_t endTime, const Coord &startPosition, const Coord &endPosition) const
+template<typename RolePolicy>
+const IListening *LoRaReceiverT<RolePolicy>::createListening(const IRadio *radio, const simtime_t startTime, const simtime_t endTime, const Coord &startPosition, const Coord &endPosition) const
 {
-    if(iAmGateway == false)
-    {
-        auto node = getContainingNode(this);
-//        auto loRaApp = check_and_cast<SimpleLoRaApp *>(node->getSubmodule("SimpleLoRaApp"));
-        auto loRaRadio = check_and_cast<LoRaRadio *>(node->getSubmodule("LoRaNic")->getSubmodule("radio"));
-        return new LoRaBandListening(radio, startTime, endTime, startPosition, endPosition, loRaRadio->loRaCF, loRaRadio->loRaBW, loRaRadio->loRaSF);
-    }
-    else {
-        return new LoRaBandListening(radio, startTime, endTime, startPosition, endPosition, LoRaCF, LoRaBW, LoRaSF);
-    }
+    if (!channelPlan.isEmpty())
+        return new LoRaChannelPlanListening(radio, startTime, endTime, startPosition, endPosition, &channelPlan);
+    Hz cf = LoRaCF, bw = LoRaBW;
+    int sf = LoRaSF;
+    RolePolicy::getRadioSettings(loRaRadio, cf, bw, sf);
+    return new LoRaBandListening(radio, startTime, endTime, startPosition, endPosition, cf, bw, sf);
 }
 
-const IListeningDecision *LoRaReceiver::computeListeningDecision(const IListening *listening, const IInterference *interference) const
+template<typename RolePolicy>
+const IListeningDecision *LoRaReceiverT<RolePolicy>::computeListeningDecision(const IListening *listening, const IInterference *interference) const
 {
     const IRadio *receiver = listening->getReceiver();
     const IRadioMedium *radioMedium = receiver->getMedium();
     const IAnalogModel *analogModel = radioMedium->getAnalogModel();
-    const INoise *noise = analogModel->computeNoise(listening, interference);
-    const ScalarNoise *loRaNoise = check_and_cast<const ScalarNoise *>(noise);
-    W maxPower = loRaNoise->computeMaxPower(listening->getStartTime(), listening->getEndTime());
+    W maxPower;
+    if (auto loRaAnalogModel = dynamic_cast<const LoRaAnalogModel *>(analogModel)) {
+        // only the maximum is needed, skip building the noise power function
+        W minPower;
+        loRaAnalogModel->computeNoisePowerRange(listening, interference, listening->getStartTime(), listening->getEndTime(), minPower, maxPower);
+    }
+    else {
+        const INoise *noise = analogModel->computeNoise(listening, interference);
+        const ScalarNoise *loRaNoise = check_and_cast<const ScalarNoise *>(noise);
+        maxPower = loRaNoise->computeMaxPower(listening->getStartTime(), listening->getEndTime());
+        delete noise;
+    }
     bool isListeningPossible = maxPower >= energyDetection;
-    delete noise;
     EV_DEBUG << "Computing whether listening is possible: maximum power = " << maxPower << ", energy detection = " << energyDetection << " -> listening is " << (isListeningPossible ? "possible" : "impossible") << endl;
     return new ListeningDecision(listening, isListeningPossible);
 }
 
-W LoRaReceiver::getSensitivity(const LoRaReception *reception) const
+template<typename RolePolicy>
+W LoRaReceiverT<RolePolicy>::getSensitivity(const LoRaReception *reception) const
 {
     //function returns sensitivity -- according to LoRa documentation, it changes with LoRa parameters
-    //Sensitivity values from Semtech SX1272/73 datasheet, table 10, Rev 3.1, March 2017
-    W sensitivity = W(math::dBmW2mW(-126.5) / 1000);
-    if(reception->getLoRaSF() == 6)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-121) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-118) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-111) / 1000);
-    }
-
-    if (reception->getLoRaSF() == 7)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-124) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-122) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-116) / 1000);
-    }
-
-    if(reception->getLoRaSF() == 8)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-127) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-125) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-119) / 1000);
-    }
-    if(reception->getLoRaSF() == 9)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-130) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-128) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-122) / 1000);
-    }
-    if(reception->getLoRaSF() == 10)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-133) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-130) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-125) / 1000);
-    }
-    if(reception->getLoRaSF() == 11)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-135) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-132) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-128) / 1000);
-    }
-    if(reception->getLoRaSF() == 12)
-    {
-        if(reception->getLoRaBW() == Hz(125000)) sensitivity = W(math::dBmW2mW(-137) / 1000);
-        if(reception->getLoRaBW() == Hz(250000)) sensitivity = W(math::dBmW2mW(-135) / 1000);
-        if(reception->getLoRaBW() == Hz(500000)) sensitivity = W(math::dBmW2mW(-129) / 1000);
-    }
-    return sensitivity;
+    return LoRaSensitivityTable::getSensitivity(reception->getLoRaSF(), reception->getLoRaBW());
 }
 
+template class LoRaReceiverT<LoRaNodeRole>;
+template class LoRaReceiverT<LoRaGatewayRole>;
+template class LoRaReceiverT<LoRaRelayRole>;
+
 }
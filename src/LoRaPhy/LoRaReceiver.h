@@ -28,21 +28,87 @@
 #include "LoRaTransmission.h"
 #include "LoRaReception.h"
 #include "LoRaBandListening.h"
+#include "LoRaChannelPlan.h"
 #include "LoRa/LoRaRadio.h"
 #include "LoRaApp/SimpleLoRaApp.h"
 #include "LoRa/LoRaMac.h"
 #include "LoRa/LoRaGWMac.h"
 
 #include "LoRaRadioControlInfo_m.h"
+#include <algorithm>
+#include <vector>
 
 
 //based on Ieee802154UWBIRReceiver
 
 namespace lpwan {
 
-class LoRaReceiver : public FlatReceiverBase
+class LoRaGWRadio;
 
+/**
+ * Role policy of an end node receiver: only transmissions with the settings
+ * of its own radio are received, and collisions of frames addressed to the
+ * node are counted.
+ */
+struct LoRaNodeRole
 {
+    typedef LoRaRadio Radio;
+    typedef LoRaMac Mac;
+
+    static constexpr bool acceptsAnySettings = false;
+    static constexpr bool emitsCollisionSignal = false;
+    static constexpr bool emitsCountedCollisions = false;
+
+    static const char *getCollisionSignalName() { return "LoRaReceptionCollision"; }
+
+    static void getRadioSettings(const Radio *radio, Hz& cf, Hz& bw, int& sf) { cf = radio->loRaCF; bw = radio->loRaBW; sf = radio->loRaSF; }
+    static MacAddress getAddress(Mac *mac) { return mac->getAddress(); }
+    static bool isCollisionCounted(Mac *mac, const MacAddress& receiverAddress) { return receiverAddress == getAddress(mac); }
+};
+
+/**
+ * Role policy of a gateway receiver: every transmission is received
+ * regardless of its settings, and collisions of uplink (broadcast) frames
+ * are counted and emitted.
+ */
+struct LoRaGatewayRole
+{
+    typedef LoRaGWRadio Radio;
+    typedef LoRaGWMac Mac;
+
+    static constexpr bool acceptsAnySettings = true;
+    static constexpr bool emitsCollisionSignal = true;
+    static constexpr bool emitsCountedCollisions = false;
+
+    static const char *getCollisionSignalName() { return "LoRaReceptionCollision"; }
+
+    static void getRadioSettings(const Radio *radio, Hz& cf, Hz& bw, int& sf);
+    static MacAddress getAddress(Mac *mac) { return mac->getAddress(); }
+    static bool isCollisionCounted(Mac *mac, const MacAddress& receiverAddress) { return receiverAddress == MacAddress::BROADCAST_ADDRESS; }
+};
+
+/**
+ * LoRa receiver parameterized with its role. The radio and the MAC of the
+ * containing NIC are resolved once during initialization, and the role
+ * specific decisions are bound at compile time. A role policy provides:
+ *  - the Radio and Mac types of the containing NIC,
+ *  - acceptsAnySettings: whether transmissions with settings different from
+ *    the listening are received,
+ *  - getRadioSettings(): the settings to listen with (left untouched if the
+ *    receiver's own settings are used),
+ *  - getAddress(): the MAC address of the node,
+ *  - isCollisionCounted(): whether a collided frame counts as lost for us,
+ *  - emitsCollisionSignal/emitsCountedCollisions and getCollisionSignalName():
+ *    when and under which name collisions are reported.
+ */
+template<typename RolePolicy>
+class LoRaReceiverT : public FlatReceiverBase
+
+{
+protected:
+    typedef typename RolePolicy::Radio Radio;
+    typedef typename RolePolicy::Mac Mac;
+
 private:
     W LoRaTP;
     Hz LoRaCF;
@@ -52,8 +118,14 @@ private:
 
     double snirThreshold;
 
-    bool iAmGateway;
     bool alohaChannelModel;
+    bool cumulativeCollisionModel;
+    bool errorModelDecision;
+    // replaces the settings the role listens with when not empty
+    LoRaChannelPlan channelPlan;
+
+    Radio *loRaRadio = nullptr;
+    Mac *macLayer = nullptr;
 
     simsignal_t LoRaReceptionCollision;
 
@@ -66,12 +138,22 @@ private:
        {-25, -25, -25, -24, -23, 1}
     };
 
+    struct CaptureEdge
+    {
+        simtime_t time;
+        int sfIndex;
+        // positive when the interference starts, negative when it ends
+        double power;
+    };
+    // reused between receptions by the cumulative collision model
+    mutable std::vector<CaptureEdge> captureEdges;
+
     //statistics
     long numCollisions;
     long rcvBelowSensitivity;
 
 public:
-  LoRaReceiver();
+  LoRaReceiverT();
 
   void initialize(int stage) override;
   void finish() override;
@@ -97,7 +179,9 @@ public:
 
   W getSensitivity(const LoRaReception *loRaReception) const;
 
+  int getCaptureThreshold(int receptionSF, int interferenceSF) const;
   bool isPacketCollided(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const;
+  bool isPacketCollidedCumulative(const IReception *reception, IRadioSignal::SignalPart part, const IInterference *interference) const;
 
   virtual void setLoRaTP(W newTP) { LoRaTP = newTP; };
   virtual void setLoRaCF(Hz newCF) { LoRaCF = newCF; };
@@ -107,6 +191,14 @@ public:
 
 
 
+};
+
+class LoRaReceiver : public LoRaReceiverT<LoRaNodeRole>
+{
+};
+
+class LoRaGWReceiver : public LoRaReceiverT<LoRaGatewayRole>
+{
 };
 
 }
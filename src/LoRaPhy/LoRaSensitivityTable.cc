@@ -0,0 +1,46 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaSensitivityTable.h"
+#include "inet/common/INETMath.h"
+#include <array>
+
+namespace lpwan {
+
+constexpr double LoRaSensitivityTable::sensitivitiesDbm[LoRaSensitivityTable::NUM_SPREADING_FACTORS][LoRaSensitivityTable::NUM_BANDWIDTHS];
+constexpr double LoRaSensitivityTable::defaultSensitivityDbm;
+
+typedef std::array<W, LoRaSensitivityTable::NUM_SPREADING_FACTORS * LoRaSensitivityTable::NUM_BANDWIDTHS + 1> Sensitivities;
+
+static Sensitivities computeSensitivities()
+{
+    Sensitivities sensitivities;
+    for (int i = 0; i < LoRaSensitivityTable::NUM_SPREADING_FACTORS; i++)
+        for (int j = 0; j < LoRaSensitivityTable::NUM_BANDWIDTHS; j++)
+            sensitivities[i * LoRaSensitivityTable::NUM_BANDWIDTHS + j] = W(math::dBmW2mW(LoRaSensitivityTable::sensitivitiesDbm[i][j]) / 1000);
+    sensitivities.back() = W(math::dBmW2mW(LoRaSensitivityTable::defaultSensitivityDbm) / 1000);
+    return sensitivities;
+}
+
+W LoRaSensitivityTable::getSensitivity(int spreadingFactor, Hz bandwidth)
+{
+    static const Sensitivities sensitivities = computeSensitivities();
+    int bandwidthIndex = getBandwidthIndex(bandwidth);
+    if (spreadingFactor < MIN_SF || spreadingFactor > MAX_SF || bandwidthIndex < 0)
+        return sensitivities.back();
+    return sensitivities[(spreadingFactor - MIN_SF) * NUM_BANDWIDTHS + bandwidthIndex];
+}
+
+} // namespace lpwan
@@ -0,0 +1,79 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORASENSITIVITYTABLE_H_
+#define LORAPHY_LORASENSITIVITYTABLE_H_
+
+#include "inet/common/Units.h"
+
+using namespace inet;
+using namespace inet::units::values;
+
+namespace lpwan {
+
+/**
+ * Receiver sensitivity per spreading factor and bandwidth, from the Semtech
+ * SX1272/73 datasheet, table 10, Rev 3.1, March 2017. It is used both as the
+ * sensitivity of the receivers and as the background noise power of the
+ * analog model.
+ */
+class LoRaSensitivityTable
+{
+  public:
+    static constexpr int MIN_SF = 6;
+    static constexpr int MAX_SF = 12;
+    static constexpr int NUM_SPREADING_FACTORS = MAX_SF - MIN_SF + 1;
+    enum BandwidthIndex {
+        BW_125KHZ,
+        BW_250KHZ,
+        BW_500KHZ,
+        NUM_BANDWIDTHS
+    };
+
+    static constexpr double sensitivitiesDbm[NUM_SPREADING_FACTORS][NUM_BANDWIDTHS] = {
+        { -121, -118, -111 }, // SF6
+        { -124, -122, -116 }, // SF7
+        { -127, -125, -119 }, // SF8
+        { -130, -128, -122 }, // SF9
+        { -133, -130, -125 }, // SF10
+        { -135, -132, -128 }, // SF11
+        { -137, -135, -129 }, // SF12
+    };
+    /**
+     * Used for spreading factors and bandwidths not in the datasheet.
+     */
+    static constexpr double defaultSensitivityDbm = -126.5;
+
+  public:
+    /**
+     * Returns the index of the bandwidth or -1 if it is not a standard LoRa
+     * bandwidth.
+     */
+    static int getBandwidthIndex(Hz bandwidth)
+    {
+        double value = bandwidth.get();
+        return value == 125000 ? BW_125KHZ : value == 250000 ? BW_250KHZ : value == 500000 ? BW_500KHZ : -1;
+    }
+
+    /**
+     * Returns the sensitivity in linear power, the datasheet values are
+     * converted once on first use.
+     */
+    static W getSensitivity(int spreadingFactor, Hz bandwidth);
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORASENSITIVITYTABLE_H_ */
@@ -0,0 +1,99 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "LoRaSpatialGrid.h"
+#include <algorithm>
+
+namespace lpwan {
+
+LoRaSpatialGrid::LoRaSpatialGrid(double cellSize) :
+    cellSize(cellSize)
+{
+}
+
+void LoRaSpatialGrid::setCellSize(double newCellSize)
+{
+    if (!(newCellSize > 0) || std::isinf(newCellSize))
+        throw cRuntimeError("Invalid spatial grid cell size: %g", newCellSize);
+    if (newCellSize == cellSize)
+        return;
+    cellSize = newCellSize;
+    cells.clear();
+    for (auto & elem : radioToEntry) {
+        elem.second.cell = getCellKey(elem.second.position);
+        insertIntoCell(elem.first, elem.second.cell);
+    }
+}
+
+void LoRaSpatialGrid::insertIntoCell(const IRadio *radio, CellKey cell)
+{
+    cells[cell].push_back(radio);
+}
+
+void LoRaSpatialGrid::removeFromCell(const IRadio *radio, CellKey cell)
+{
+    auto it = cells.find(cell);
+    if (it == cells.end())
+        return;
+    auto& cellRadios = it->second;
+    auto jt = std::find(cellRadios.begin(), cellRadios.end(), radio);
+    if (jt != cellRadios.end()) {
+        *jt = cellRadios.back();
+        cellRadios.pop_back();
+    }
+    if (cellRadios.empty())
+        cells.erase(it);
+}
+
+void LoRaSpatialGrid::addRadio(const IRadio *radio, const Coord& position)
+{
+    if (contains(radio))
+        throw cRuntimeError("Radio %d is already in the spatial grid", radio->getId());
+    RadioEntry entry;
+    entry.position = position;
+    entry.cell = std::isnan(cellSize) ? 0 : getCellKey(position);
+    radioToEntry[radio] = entry;
+    if (!std::isnan(cellSize))
+        insertIntoCell(radio, entry.cell);
+}
+
+void LoRaSpatialGrid::removeRadio(const IRadio *radio)
+{
+    auto it = radioToEntry.find(radio);
+    if (it == radioToEntry.end())
+        return;
+    if (!std::isnan(cellSize))
+        removeFromCell(radio, it->second.cell);
+    radioToEntry.erase(it);
+}
+
+void LoRaSpatialGrid::updateRadio(const IRadio *radio, const Coord& position)
+{
+    auto it = radioToEntry.find(radio);
+    if (it == radioToEntry.end())
+        return;
+    RadioEntry& entry = it->second;
+    entry.position = position;
+    if (std::isnan(cellSize))
+        return;
+    CellKey cell = getCellKey(position);
+    if (cell != entry.cell) {
+        removeFromCell(radio, entry.cell);
+        entry.cell = cell;
+        insertIntoCell(radio, cell);
+    }
+}
+
+} // namespace lpwan
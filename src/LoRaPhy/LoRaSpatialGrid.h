@@ -0,0 +1,101 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef LORAPHY_LORASPATIALGRID_H_
+#define LORAPHY_LORASPATIALGRID_H_
+
+#include "inet/common/geometry/common/Coord.h"
+#include "inet/physicallayer/wireless/common/contract/packetlevel/IRadio.h"
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace inet;
+using namespace inet::physicallayer;
+
+namespace lpwan {
+
+/**
+ * Uniform 2D grid of radio antenna positions. Radios are bucketed into square
+ * cells on the x/y plane, so that the radios around a position can be found
+ * by visiting the few cells overlapping the query circle instead of every
+ * radio on the medium. The z coordinate is ignored for bucketing.
+ */
+class LoRaSpatialGrid
+{
+  protected:
+    typedef int64_t CellKey;
+
+    struct RadioEntry
+    {
+        Coord position;
+        CellKey cell;
+    };
+
+    double cellSize;
+    std::unordered_map<CellKey, std::vector<const IRadio *>> cells;
+    std::unordered_map<const IRadio *, RadioEntry> radioToEntry;
+
+  protected:
+    static CellKey makeKey(int64_t cx, int64_t cy) { return (cx << 32) ^ (cy & 0xFFFFFFFF); }
+    int64_t getCellIndex(double c) const { return (int64_t)std::floor(c / cellSize); }
+    CellKey getCellKey(const Coord& position) const { return makeKey(getCellIndex(position.x), getCellIndex(position.y)); }
+    void insertIntoCell(const IRadio *radio, CellKey cell);
+    void removeFromCell(const IRadio *radio, CellKey cell);
+
+  public:
+    LoRaSpatialGrid(double cellSize = NaN);
+
+    double getCellSize() const { return cellSize; }
+    /**
+     * Changes the cell size and rebuckets every radio. Non-positive or NaN
+     * values are rejected.
+     */
+    void setCellSize(double cellSize);
+
+    size_t size() const { return radioToEntry.size(); }
+    bool contains(const IRadio *radio) const { return radioToEntry.find(radio) != radioToEntry.end(); }
+    const Coord& getPosition(const IRadio *radio) const { return radioToEntry.at(radio).position; }
+
+    void addRadio(const IRadio *radio, const Coord& position);
+    void removeRadio(const IRadio *radio);
+    void updateRadio(const IRadio *radio, const Coord& position);
+
+    /**
+     * Calls f for every radio in the cells overlapping the circle of the
+     * given range around center. The result is a superset of the radios
+     * within range; callers needing an exact answer must filter by distance.
+     */
+    template<typename F> void mapRadios(const Coord& center, double range, F f) const
+    {
+        int64_t minX = getCellIndex(center.x - range);
+        int64_t maxX = getCellIndex(center.x + range);
+        int64_t minY = getCellIndex(center.y - range);
+        int64_t maxY = getCellIndex(center.y + range);
+        for (int64_t cx = minX; cx <= maxX; cx++) {
+            for (int64_t cy = minY; cy <= maxY; cy++) {
+                auto it = cells.find(makeKey(cx, cy));
+                if (it != cells.end())
+                    for (auto radio : it->second)
+                        f(radio);
+            }
+        }
+    }
+};
+
+} // namespace lpwan
+
+#endif /* LORAPHY_LORASPATIALGRID_H_ */
@@ -17,6 +17,7 @@
 #include "inet/physicallayer/wireless/common/analogmodel/packetlevel/ScalarTransmission.h"
 #include "LoRaModulation.h"
 #include "LoRaPhyPreamble_m.h"
+#include "LoRaAirtime.h"
 #include <algorithm>
 
 
@@ -63,19 +64,13 @@ const ITransmission *LoRaTransmitter::createTransmission(const IRadio *transmitt
     EV << macFrame->getDetailStringRepresentation(evFlags) << endl;
     const auto &frame = macFrame->peekAtFront<LoRaPhyPreamble>();
 
-    int nPreamble = 8;
-    simtime_t Tsym = (pow(2, frame->getSpreadFactor()))/(frame->getBandwidth().get()/1000);
-    simtime_t Tpreamble = (nPreamble + 4.25) * Tsym / 1000;
-
-    //preambleDuration = Tpreamble;
-    int payloadBytes = 0;
-    if(iAmGateway) payloadBytes = 15;
-    else payloadBytes = 20;
-    int payloadSymbNb = 8;
-    payloadSymbNb += std::ceil((8*payloadBytes - 4*frame->getSpreadFactor() + 28 + 16 - 20*0)/(4*(frame->getSpreadFactor()-2*0)))*(frame->getCodeRendundance() + 4);
-    if(payloadSymbNb < 8) payloadSymbNb = 8;
-    simtime_t Theader = 0.5 * (8+payloadSymbNb) * Tsym / 1000;
-    simtime_t Tpayload = 0.5 * (8+payloadSymbNb) * Tsym / 1000;
+    // the PHY payload is everything behind the preamble chunk
+    int payloadBytes = (int)std::ceil((macFrame->getDataLength() - frame->getChunkLength()).get() / 8.0);
+    int spreadFactor = frame->getSpreadFactor();
+    double bandwidth = frame->getBandwidth().get();
+    simtime_t Tpreamble = LoRaAirtime::getPreambleDuration(spreadFactor, bandwidth);
+    simtime_t Theader = LoRaAirtime::getHeaderDuration(spreadFactor, bandwidth);
+    simtime_t Tpayload = LoRaAirtime::getDataDuration(payloadBytes, spreadFactor, bandwidth, frame->getCodeRendundance(), frame->getUseHeader());
 
     const simtime_t duration = Tpreamble + Theader + Tpayload;
     const simtime_t endTime = startTime + duration;